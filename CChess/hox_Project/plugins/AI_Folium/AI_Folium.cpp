@@ -25,6 +25,7 @@
 
 #include <AIEngineLib.h>
 #include <DefaultDelete.h>
+#include <cstdlib>
 #include <memory>
 #include "engine.h"
 #include "folHOXEngine.h"
@@ -34,6 +35,9 @@ class AIEngineImpl : public DefaultDelete<AIEngineLib>
 public:
     AIEngineImpl( const char* engineName )
         : m_name( engineName ? engineName : "__UNKNOWN__" )
+        , m_gameTime( 0 )
+        , m_increment( 0 )
+        , m_movesToGo( 0 )
     {
     }
 
@@ -49,7 +53,14 @@ public:
     void initEngine( int nAILevel = 0 )
     {
         const int nDepth = ( nAILevel < 1 ? 3 : nAILevel );
-        m_engine.reset( new folHOXEngine( nDepth ) );
+        if ( m_engine.get() == NULL )
+        {
+            m_engine.reset( new folHOXEngine( nDepth ) );
+        }
+        else
+        {
+            m_engine->SetSearchDepth( nDepth );
+        }
     }
 
   	int initGame( const std::string& fen,
@@ -95,8 +106,66 @@ public:
 
     std::string getInfo()
     {
-        return "Wangmao Lin\n"
-               "folium.googlecode.com";
+        std::string sInfo = "Wangmao Lin\n"
+                            "folium.googlecode.com";
+        const std::string sStats =
+            ( m_engine.get() != NULL ? m_engine->GetStats() : "" );
+        if ( ! sStats.empty() )
+        {
+            sInfo += "\n\n" + sStats;  // Of the last move.
+        }
+        return sInfo;
+    }
+
+    int setOption( const std::string& name,
+                   const std::string& value )
+    {
+        if ( m_engine.get() == NULL ) return hoxAI_RC_ERR;
+
+        if ( name == "Threads" )
+        {
+            m_engine->SetThreads( ::atoi( value.c_str() ) );
+            return hoxAI_RC_OK;
+        }
+        if ( name == "StatsLog" )  // A file, or "" for none.
+        {
+            m_engine->SetStatsLog( value );
+            return hoxAI_RC_OK;
+        }
+        if ( name == "MoveTime" )  // In ms.
+        {
+            m_engine->SetMoveTime( ::atoi( value.c_str() ) );
+            return hoxAI_RC_OK;
+        }
+        if (    name == "GameTime"   // In ms.
+             || name == "Increment"  // In ms.
+             || name == "MovesToGo" )
+        {
+            int& field = (   name == "GameTime"  ? m_gameTime
+                           : name == "Increment" ? m_increment
+                                                 : m_movesToGo );
+            field = ::atoi( value.c_str() );
+            m_engine->SetTimeControl( m_gameTime, m_increment, m_movesToGo );
+            return hoxAI_RC_OK;
+        }
+        return hoxAI_RC_NOT_SUPPORTED;
+    }
+
+    int perft( int                 depth,
+               unsigned long long& nodes )
+    {
+        if ( m_engine.get() == NULL ) return hoxAI_RC_ERR;
+
+        nodes = m_engine->Perft( depth );
+        return hoxAI_RC_OK;
+    }
+
+    int getNodeCount( unsigned long long& nodes )
+    {
+        if ( m_engine.get() == NULL ) return hoxAI_RC_ERR;
+
+        nodes = m_engine->GetNodeCount();
+        return hoxAI_RC_OK;
     }
 
 private:
@@ -105,6 +174,10 @@ private:
     typedef std::auto_ptr<folHOXEngine>  Engine_APtr;
     Engine_APtr    m_engine;
 
+    int            m_gameTime;   // The game clock (ms), as set by options.
+    int            m_increment;
+    int            m_movesToGo;
+
 }; /* class AIEngineImpl */
 
 
@@ -1,13 +1,16 @@
 #include "engine.h"
+#include "generator.h"
 #include "xq_position_data.h"
 #include "utility/time.h"
 
 #include <boost/format.hpp>
 
 #include <ctime>
+#include <thread>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <limits>
 namespace folium
 {
 
@@ -16,12 +19,69 @@ namespace folium
         m_stop(true),
         m_ponder(false),
         m_depth(8),
-        m_starttime(0.0f),
-        m_mintime(0.0f),
-        m_maxtime(0.0f),
-        m_hash(21)
+        m_threads(1),
+        m_starttime(0),
+        m_mintime(0),
+        m_maxtime(0),
+        m_game_time(0),
+        m_increment(0),
+        m_moves_to_go(0),
+        m_move_time(0),
+        m_hash(new HashTable(21)),
+        m_main(0),
+        m_start_depth(1)
     {
-        load("rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR r");
+        reset("rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR r");
+        clear_stats();
+    }
+
+    Engine::Engine(Engine* main):
+        m_debug(false),
+        m_stop(true),
+        m_ponder(false),
+        m_depth(main->m_depth),
+        m_threads(1),
+        m_starttime(0),
+        m_mintime(0),
+        m_maxtime(0),
+        m_game_time(0),
+        m_increment(0),
+        m_moves_to_go(0),
+        m_move_time(0),
+        m_hash(main->m_hash),
+        m_main(main),
+        m_start_depth(1)
+    {
+        reset("rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR r");
+        clear_stats();
+    }
+
+    Engine::~Engine()
+    {
+        for (uint i = 0; i < m_helpers.size(); ++i)
+            delete m_helpers[i];
+        if (!m_main)
+            delete m_hash;
+    }
+
+    //a helper searches the position of its main engine, with the moves
+    //played to it (for the repetitions), but with no time limit: the main
+    //engine stops it
+    void Engine::sync(const Engine& main)
+    {
+        m_xq = main.m_xq;
+        m_ply = main.m_ply;
+        for (int i = 0; i <= m_ply; ++i)
+        {
+            m_keys[i] = main.m_keys[i];
+            m_locks[i] = main.m_locks[i];
+            m_values[i] = main.m_values[i];
+            m_traces[i] = main.m_traces[i];
+        }
+        m_depth = main.m_depth;
+        m_ponder = false;
+        m_mintime = m_maxtime = std::numeric_limits<sint64>::max();
+        m_stop = false;
     }
 
     void Engine::setxq(const XQ& xq)
@@ -58,6 +118,66 @@ namespace folium
         return false;
     }
 
+    bool Engine::reset(const string& fen)
+    {
+        if (!load(fen))
+            return false;
+        //the hash table is not wiped (that costs as much as allocating it):
+        //its records are locked by position, and a new search ages them
+        m_history.clear();
+        for (int i = 0; i <= LIMIT_DEPTH; ++i)
+            m_killers[i].clear();
+        for (uint i = 0; i < m_helpers.size(); ++i)
+            m_helpers[i]->reset(fen);
+        m_stop = true;
+        m_ponder = false;
+        return true;
+    }
+
+    void Engine::set_hash_size(uint mb)
+    {
+        //a record takes 16 bytes, so 1MB holds 2^16 of them
+        uint32 power = 16;
+        while (power < 30 && (mb >> (power - 15)) != 0)
+            ++power;
+        m_hash->resize(power);
+    }
+
+    const int TIME_MOVES_LEFT = 30;//the number of moves the clock is shared by
+    const int TIME_MARGIN = 50;//the part of the clock (ms) never used
+
+    //the soft limit is the time for this move, the hard one up to 4 times
+    //as much (for a hard iteration), but within the clock; with no time
+    //control, only the depth limits the search. Neither is under 1 ms: on
+    //a short clock, the first iteration must still be searched
+    void Engine::allocate_time()
+    {
+        sint64 soft, hard;
+        m_starttime = now_time();
+        if (m_game_time > 0)
+        {
+            int moves_left = m_moves_to_go > 0 ? std::min(m_moves_to_go, TIME_MOVES_LEFT) : TIME_MOVES_LEFT;
+            soft = m_game_time / moves_left + m_increment * 3 / 4;
+            hard = std::min<sint64>(soft * 4, m_game_time - TIME_MARGIN);
+            if (m_move_time > 0)
+                hard = std::min<sint64>(hard, m_move_time);
+        }
+        else if (m_move_time > 0)
+        {
+            soft = m_move_time / 2;
+            hard = m_move_time;
+        }
+        else
+        {
+            m_mintime = m_maxtime = std::numeric_limits<sint64>::max();
+            return;
+        }
+        hard = std::max<sint64>(hard, 1);
+        soft = std::max<sint64>(std::min(soft, hard), 1);
+        m_mintime = m_starttime + soft;
+        m_maxtime = m_starttime + hard;
+    }
+
     void Engine::interrupt()
     {
         if (!m_ponder && now_time() >= m_maxtime)
@@ -67,10 +187,15 @@ namespace folium
             string line = readline();
             if (line == "isready")
                 writeline("readyok");
-            else if (line == "stop")
+            else if (line == "stop" || line == "quit")
                 m_stop = true;
             else if (line == "ponderhit")
+            {
+                //the time spent pondering was the opponent's: the clock
+                //starts now
                 m_ponder = false;
+                allocate_time();
+            }
         }
     }
 
@@ -85,13 +210,16 @@ namespace folium
         dst_piece = m_xq.coordinate(dst);
         assert(dst_piece != RedKingIndex && dst_piece != BlackKingIndex);
 
-        if (!m_xq.do_move(src, dst))
+        //the attack scans (for a self-check, then for a check) are done only
+        //for the moves that can need them
+        bool verify = trace_flag(m_traces[m_ply]) || m_xq.may_expose(src, dst);
+        if (!m_xq.do_move(src, dst, verify))
         {
             return false;
         }
 
         ++m_ply;
-        m_traces[m_ply] = create_trace(status(m_xq), dst_piece, move);
+        m_traces[m_ply] = create_trace(m_xq.may_check(src, dst) ? status(m_xq) : 0, dst_piece, move);
         if (dst_piece == EmptyIndex)
         {
             m_keys[m_ply] = m_keys[m_ply-1]\
@@ -122,6 +250,17 @@ namespace folium
         return true;
     }
 
+    bool Engine::play(uint32 move)
+    {
+        if (!is_legal_move(move))
+            return false;
+        //the history arrays hold 512 plies, searches included: in a very
+        //long game, forget the moves played so far (and their repetitions)
+        if (m_ply >= 256)
+            setxq(m_xq);
+        return make_move(move);
+    }
+
     void Engine::unmake_move()
     {
         assert (m_ply > 0);
@@ -129,248 +268,147 @@ namespace folium
         m_xq.undo_move(trace_src(trace), trace_dst(trace), trace_dst_piece(trace));
     }
 
-
-
-    static vector<uint> generate_moves(const XQ& xq)
+    uint64 Engine::perft(int depth)
     {
-        vector<uint> ml;
-        uint own = xq.player();
-        uint opp = 1 - own;
-        uint idx;
-        uint src, dst;
-        if (own == Red)
-        {
-            idx = RedKingIndex;
-            //red king
-            src = xq.piece(RedKingIndex);
-            const uint8 *pm = g_red_king_pawn_moves[src];
-            dst = *pm++;
-            while (dst != InvaildCoordinate)
-            {
-                if (xq.coordinate_color(dst) != own)
-                    ml.push_back(create_move(src, dst));
-                dst = *pm++;
-            }
-            //red pawn
-            for (uint i = RedPawnIndex1; i <= RedPawnIndex5; ++i)
-            {
-                src = xq.piece(i);
-                if (src == InvaildCoordinate)
-                    continue;
-                pm = g_red_king_pawn_moves[src];
-                dst = *pm++;
-                while (dst != InvaildCoordinate)
-                {
-                    if (xq.coordinate_color(dst) != own)
-                        ml.push_back(create_move(src, dst));
-                    dst = *pm++;
-                }
-            }
-        }
-        else
-        {
-            idx = BlackKingIndex;
-            //black king
-            src = xq.piece(BlackKingIndex);
-            const uint8 *pm = g_black_king_pawn_moves[src];
-            dst = *pm++;
-            while (dst != InvaildCoordinate)
-            {
-                if (xq.coordinate_color(dst) != own)
-                    ml.push_back(create_move(src, dst));
-                dst = *pm++;
-            }
-            //black pawn
-            for (uint i = BlackPawnIndex1; i <= BlackPawnIndex5; ++i)
-            {
-                src = xq.piece(i);
-                if (src == InvaildCoordinate)
-                    continue;
-                pm = g_black_king_pawn_moves[src];
-                dst = *pm++;
-                while (dst != InvaildCoordinate)
-                {
-                    if (xq.coordinate_color(dst) != own)
-                        ml.push_back(create_move(src, dst));
-                    dst = *pm++;
-                }
-            }
-        }
-        //advisor
-        for (uint i = 0; i < 2; ++i)
-        {
-            ++idx;
-            src = xq.piece(idx);
-            if (src == InvaildCoordinate)
-                continue;
-            const uint8 *pm = g_advisor_bishop_moves[src];
-            dst = *pm++;
-            while (dst != InvaildCoordinate)
-            {
-                if (xq.coordinate_color(dst) != own)
-                    ml.push_back(create_move(src, dst));
-                dst = *pm++;
-            }
-        }
-        //bishop
-        for (uint i = 0; i < 2; ++i)
-        {
-            ++idx;
-            src = xq.piece(idx);
-            if (src == InvaildCoordinate)
-                continue;
-            const uint8 *pm = g_advisor_bishop_moves[src];
-            dst = *pm++;
-            while (dst != InvaildCoordinate)
-            {
-                if (xq.coordinate_color(dst) != own && xq.coordinate_is_empty((dst + src) >> 1))
-                    ml.push_back(create_move(src, dst));
-                dst = *pm++;
-            }
-        }
-        //rook
-        for (uint i = 0; i < 2; ++i)
-        {
-            uint dst;
-            src = xq.piece(++idx);
-            if (src == InvaildCoordinate)
-                continue;
-            dst = xq.nonempty_left_1(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            dst = xq.nonempty_right_1(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            dst = xq.nonempty_down_1(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            dst = xq.nonempty_up_1(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_left_1(src), dst = coordinate_left(src);
-                    dst != tmp;
-                    dst = coordinate_left(dst))
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_right_1(src), dst = coordinate_right(src);
-                    dst != tmp;
-                    dst = coordinate_right(dst))
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_down_1(src), dst = coordinate_down(src);
-                    dst != tmp;
-                    dst = coordinate_down(dst))
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_up_1(src), dst = coordinate_up(src);
-                    dst != tmp;
-                    dst = coordinate_up(dst))
-                ml.push_back(create_move(src, dst));
-        }
-        //knight
-        for (uint i = 0; i < 2; ++i)
-        {
-            ++idx;
-            src = xq.piece(idx);
-            if (src == InvaildCoordinate)
-                continue;
-            const uint16 *pm = g_kinght_moves[src];
-            dst = *pm++;
-            //23130 = ((InvaildCoordinate << 8) | InvaildCoordinate)
-            while (dst != 23130UL)
-            {
-                uint leg = (dst & 0xff00) >> 8;
-                dst &= 0xff;
-                if (xq.coordinate_is_empty(leg) && xq.coordinate_color(dst) != own)
-                    ml.push_back(create_move(src, dst));
-                dst = *pm++;
-            }
-        }
-        //cannon
-        for (uint i = 0; i < 2; ++i)
+        if (depth <= 0)
+            return 1;
+        MoveList ml;
+        generate_moves(m_xq, ml, m_history);
+        uint64 leaves = 0;
+        for (uint i = 0; i < ml.size(); ++i)
         {
-            uint dst;
-            src = xq.piece(++idx);
-            if (src == InvaildCoordinate)
+            if (!make_move(ml[i]))
                 continue;
-            dst = xq.nonempty_left_2(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            dst = xq.nonempty_right_2(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            dst = xq.nonempty_down_2(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            dst = xq.nonempty_up_2(src);
-            if (xq.coordinate_color(dst) == opp)
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_left_1(src), dst = coordinate_left(src);
-                    dst != tmp;
-                    dst = coordinate_left(dst))
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_right_1(src), dst = coordinate_right(src);
-                    dst != tmp;
-                    dst = coordinate_right(dst))
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_down_1(src), dst = coordinate_down(src);
-                    dst != tmp;
-                    dst = coordinate_down(dst))
-                ml.push_back(create_move(src, dst));
-            for (uint tmp = xq.nonempty_up_1(src), dst = coordinate_up(src);
-                    dst != tmp;
-                    dst = coordinate_up(dst))
-                ml.push_back(create_move(src, dst));
+            leaves += perft(depth - 1);
+            unmake_move();
         }
-        return ml;
+        return leaves;
     }
 
-    static vector<uint> generate_root_move(XQ& xq, const set<uint>& ban)
+    //the legal moves at the root, but the banned ones, in the generation
+    //order (a move taking the king, if any, alone)
+    static void generate_root_moves(XQ& xq, const History& history, const MoveSet& ban, MoveList& r)
     {
-        vector<uint> r;
-        vector<uint> ml = generate_moves(xq);
+        MoveList ml;
+        generate_moves(xq, ml, history);
+        r.clear();
         for (uint i = 0; i < ml.size(); ++i)
         {
-            uint move = ml[i];
+            uint move = ml[i] & 0x3fff;
             uint dst_piece = xq.coordinate(move_dst(move));
             if (dst_piece == RedKingIndex || dst_piece == BlackKingIndex)
             {
                 r.clear();
-                r.push_back(move);
-                return r;
+                r.push(move);
+                return;
             }
-            if (ban.find(move) != ban.end())
+            if (ban.test(move))
                 continue;
             if (xq.do_move(move_src(move), move_dst(move)))
             {
-                r.push_back(move);
+                r.push(move);
                 xq.undo_move(move_src(move), move_dst(move), dst_piece);
             }
         }
-        return r;
     }
-    uint32 Engine::search(set<uint> ban)
+
+    //lazy SMP: the helpers search the same position on threads of their own,
+    //every other one a ply ahead, and share only the hash table; the move
+    //is the one of this (main) search
+    uint32 Engine::search(const MoveSet& ban)
     {
-        m_interrupt = 0;
+        //neither table is swept: the history scores carry over (they are
+        //halved when one grows too big), and the hash entries just get older
+        m_hash->new_search();
 
+        int helpers = std::max(1, std::min(m_threads, MAX_THREADS)) - 1;
+        while (static_cast<int>(m_helpers.size()) > helpers)
+        {
+            delete m_helpers.back();
+            m_helpers.pop_back();
+        }
+        while (static_cast<int>(m_helpers.size()) < helpers)
+            m_helpers.push_back(new Engine(this));
+
+        vector<std::thread> threads;
+        for (uint i = 0; i < m_helpers.size(); ++i)
+        {
+            m_helpers[i]->sync(*this);
+            m_helpers[i]->m_start_depth = 1 + (i & 1);
+            threads.push_back(std::thread(&Engine::search_root, m_helpers[i], std::cref(ban)));
+        }
+        sint64 start = now_time();
+        uint32 move = search_root(ban);
+        for (uint i = 0; i < m_helpers.size(); ++i)
+            m_helpers[i]->m_stop = true;
+        for (uint i = 0; i < threads.size(); ++i)
+            threads[i].join();
+        m_search_time = now_time() - start;
+        return move;
+    }
+
+    void Engine::clear_stats()
+    {
         m_tree_nodes = 0;
         m_leaf_nodes = 0;
         m_quiet_nodes = 0;
+        m_hash_probes = 0;
+        m_hash_hits = 0;
         m_hash_hit_nodes = 0;
         m_hash_move_cuts = 0;
         m_kill_cuts_1 = 0;
         m_kill_cuts_2 = 0;
         m_null_nodes = 0;
         m_null_cuts = 0;
+        m_search_time = 0;
+        m_iterations = 0;
+    }
 
-        m_history.clear();
-        m_hash.clear();
+    SearchStats Engine::stats()const
+    {
+        SearchStats s;
+        s.nodes = nodes();
+        s.qnodes = m_leaf_nodes + m_quiet_nodes;
+        s.time = m_search_time;
+        s.hash_probes = m_hash_probes;
+        s.hash_hits = m_hash_hits;
+        s.hash_cuts = m_hash_hit_nodes;
+        s.hash_move_cuts = m_hash_move_cuts;
+        s.killer_cuts = m_kill_cuts_1 + m_kill_cuts_2;
+        s.null_tries = m_null_nodes;
+        s.null_cuts = m_null_cuts;
+        for (uint i = 0; i < m_helpers.size(); ++i)
+        {
+            SearchStats h = m_helpers[i]->stats();
+            s.qnodes += h.qnodes;
+            s.hash_probes += h.hash_probes;
+            s.hash_hits += h.hash_hits;
+            s.hash_cuts += h.hash_cuts;
+            s.hash_move_cuts += h.hash_move_cuts;
+            s.killer_cuts += h.killer_cuts;
+            s.null_tries += h.null_tries;
+            s.null_cuts += h.null_cuts;
+        }
+        for (int i = 0; i < m_iterations; ++i)
+            s.iterations.push_back(m_iteration_nodes[i] - (i ? m_iteration_nodes[i - 1] : 0));
+        return s;
+    }
+
+    uint32 Engine::search_root(const MoveSet& ban)
+    {
+        m_interrupt = 0;
+        clear_stats();
 
         m_null_ply = 0;
         m_start_ply = m_ply;
 
         int best_value;
-        vector<uint> ml = generate_root_move(m_xq, ban);
+        MoveList ml;
+        generate_root_moves(m_xq, m_history, ban, ml);
         uint best_move = 0;
-        for (sint depth = 1;
-            !m_stop && depth < m_depth  && now_time() < m_mintime;
+        //the soft limit is not checked until there is a move to play
+        for (sint depth = m_start_depth;
+            !m_stop && depth < m_depth  && (!best_move || m_ponder || now_time() < m_mintime);
             ++depth)
         {
             if (ml.size() == 1)
@@ -378,16 +416,22 @@ namespace folium
             else if (ml.size() ==0)
                 return 0;
 
-            vector<uint>::iterator itr = find(ml.begin(), ml.end(), best_move);
-            if (itr != ml.begin() && itr != ml.end())
-                swap(*ml.begin(), *itr);
+            for (uint i = 1; i < ml.size(); ++i)
+            {
+                if (ml[i] == best_move)
+                {
+                    swap(ml[0], ml[i]);
+                    break;
+                }
+            }
 
             best_value = -INVAILDVALUE;
-            for (vector<uint>::iterator itr = ml.begin(); itr != ml.end(); ++itr)
+            for (uint i = 0; i < ml.size(); ++i)
             {
-                if (!make_move(*itr))
+                uint32& move = ml[i];
+                if (!make_move(move))
                 {
-                    *itr = 0;
+                    move = 0;
                     continue;
                 }
                 int score;
@@ -404,21 +448,34 @@ namespace folium
                     break;
                 if (score > best_value)
                 {
-                    writeline(str( boost::format("info move %s depth %d score %d") % move2ucci(*itr) % depth % score));
+                    if (!m_main && writable())
+                        writeline(str( boost::format("info depth %d score %d pv %s") % depth % score % move2ucci(move)));
                     if (score > best_value)
                     {
-                        best_move = *itr;
+                        best_move = move;
                         best_value = score;
                     }
                 }
                 else if (score < -MATEVALUE)
-                    *itr = 0;
+                    move = 0;
             }
 
+            if (!m_stop)
+                m_iteration_nodes[m_iterations++] = m_tree_nodes + m_leaf_nodes + m_quiet_nodes;
             if (best_value > MATEVALUE || best_value < -MATEVALUE)
                 break;
-            ml.erase(remove(ml.begin(), ml.end(), (uint)0), ml.end());
+            uint size = 0;
+            for (uint i = 0; i < ml.size(); ++i)
+            {
+                if (ml[i])
+                    ml[size++] = ml[i];
+            }
+            ml.resize(size);
         }
+        //stopped (by the hard limit) before a move was searched: any legal
+        //move is better than none
+        for (uint i = 0; !best_move && i < ml.size(); ++i)
+            best_move = ml[i];
         return best_move;
     }
 }
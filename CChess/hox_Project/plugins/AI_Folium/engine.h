@@ -1,8 +1,10 @@
 #ifndef _ENGINE_H_
 #define _ENGINE_H_
 
-#include <set>
+#include <atomic>
+#include <bitset>
 #include <string>
+#include <vector>
 
 #include "defines.h"
 #include "movelist.h"
@@ -10,37 +12,83 @@
 #include "xq.h"
 #include "history.h"
 #include "hash.h"
+#include "killer.h"
 
 namespace folium
 {
-    using std::set;
     using std::string;
+    using std::vector;
+
+    const int LIMIT_DEPTH = 64;
+    const int MAX_THREADS = 64;
+
+    //a set of moves (by their 14 bits, src | dst << 7), with no allocation
+    typedef std::bitset<0x4000> MoveSet;
+
+    //the counters of a search (its helpers' included), to tune the hash
+    //size and the time
+    struct SearchStats
+    {
+        uint64 nodes;//all of them
+        uint64 qnodes;//of the leaf and quiescence searches
+        sint64 time;//ms
+        uint64 hash_probes;
+        uint64 hash_hits;//the lock matched
+        uint64 hash_cuts;//the record gave the score
+        uint64 hash_move_cuts;//beta cutoffs by the hash move
+        uint64 killer_cuts;//beta cutoffs by a killer
+        uint64 null_tries;
+        uint64 null_cuts;
+        vector<uint64> iterations;//the main search's nodes, by depth from 1
+    };
+
     class Engine
     {
     public:
         Engine();
-        virtual ~Engine() {}
+        virtual ~Engine();
         void setxq(const XQ&);
         bool load(const string& fen);
+        bool reset(const string& fen);//a new game, in the same hash table
         string fen(){return m_xq.get_fen();}
+        void set_hash_size(uint mb);//rounded down to a power of 2, 1MB at least
 
         virtual bool readable() {return false;};
+        virtual bool writable() {return false;};//whether writeline() goes anywhere
         virtual string readline(){return string();};
         virtual void writeline(const string& str){};
 
         bool make_move(uint32 move);
+        bool play(uint32 move);//checks a move from outside first
         void unmake_move();
 
-        uint32 search(set<uint>);
+        uint32 search(const MoveSet& ban = MoveSet());//searches no banned move
+        uint64 perft(int depth);//legal move sequences of depth plies
+        uint64 nodes()const;//nodes searched by the last search
+        SearchStats stats()const;//of the last search
 
         bool m_debug;
-        bool m_stop;
+        std::atomic<bool> m_stop;
         bool m_ponder;
         int m_depth;
-        double m_starttime;
-        double m_mintime;
-        double m_maxtime;
+        int m_threads;//lazy SMP: the threads searching each move
+        sint64 m_starttime;//by now_time() (ms)
+        sint64 m_mintime;//the soft limit: no new iteration is started after it
+        sint64 m_maxtime;//the hard limit: the search stops
+
+        //the time control (ms), from which allocate_time() sets the limits
+        int m_game_time;//the time left on our clock, or 0
+        int m_increment;
+        int m_moves_to_go;//until the next time control, or 0
+        int m_move_time;//the most to spend on a move, or 0
+        void allocate_time();
     private:
+        explicit Engine(Engine* main);//a helper, sharing main's hash table
+        Engine(const Engine&);
+        Engine& operator=(const Engine&);
+        void sync(const Engine& main);
+        uint32 search_root(const MoveSet& ban);
+        void clear_stats();
         void interrupt();
         void do_null();
         void undo_null();
@@ -60,19 +108,28 @@ namespace folium
         sint32 m_values[512];
         uint32 m_traces[512];
         History m_history;
-        HashTable m_hash;
+        HashTable* m_hash;//owned, but a helper's is its main engine's
+        Killer m_killers[LIMIT_DEPTH+1];
+        Engine* m_main;//0, but for a helper
+        vector<Engine*> m_helpers;
+        int m_start_depth;//of the iterative deepening
 		volatile uint m_interrupt;
 
     private:
-		uint m_tree_nodes;
-		uint m_leaf_nodes;
-		uint m_quiet_nodes;
-		uint m_hash_hit_nodes;
-		uint m_hash_move_cuts;
-		uint m_kill_cuts_1;
-		uint m_kill_cuts_2;
-		uint m_null_nodes;
-		uint m_null_cuts;
+		uint64 m_tree_nodes;
+		uint64 m_leaf_nodes;
+		uint64 m_quiet_nodes;
+		uint64 m_hash_probes;
+		uint64 m_hash_hits;
+		uint64 m_hash_hit_nodes;
+		uint64 m_hash_move_cuts;
+		uint64 m_kill_cuts_1;
+		uint64 m_kill_cuts_2;
+		uint64 m_null_nodes;
+		uint64 m_null_cuts;
+		sint64 m_search_time;
+		uint64 m_iteration_nodes[LIMIT_DEPTH];//the nodes so far, after each depth
+		int m_iterations;
 
     };
 
@@ -98,6 +155,14 @@ namespace folium
         return INVAILDVALUE;
     }
 
+    inline uint64 Engine::nodes()const
+    {
+        uint64 nodes = m_tree_nodes + m_leaf_nodes + m_quiet_nodes;
+        for (uint i = 0; i < m_helpers.size(); ++i)
+            nodes += m_helpers[i]->nodes();
+        return nodes;
+    }
+
     inline bool Engine::is_legal_move(uint move)
     {
         return move &&  folium::is_legal_move(m_xq, move_src(move), move_dst(move)) && m_xq.player() == m_xq.coordinate_color(move_src(move));
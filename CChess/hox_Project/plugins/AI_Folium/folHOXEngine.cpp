@@ -25,10 +25,12 @@
 // Description:     This is 'folium' Engine to interface with HOXChess.
 /////////////////////////////////////////////////////////////////////////////
 
-#include "utility/time.h"
 #include "engine.h"
 #include "folHOXEngine.h"
+#include <algorithm>   // min, max
 #include <sstream>     // ostringstream
+#include <fstream>     // ofstream
+#include <iomanip>     // setprecision
 
 
 // ----------------------------------------------------------------------------
@@ -38,9 +40,14 @@
 // ----------------------------------------------------------------------------
 
 folHOXEngine::folHOXEngine( const int searchDepth /* = 3 */ )
-        : _engine( NULL )
+        : _engine( new folium::Engine() )
         , _searchDepth( searchDepth )
+        , _searched( false )
 {
+    /* NOTE: The engine (and its big hash table) lives as long as we do.
+     *       A new game only resets it.
+     */
+    _engine->m_move_time = 3000;  // The default limit, in ms.
 }
 
 folHOXEngine::~folHOXEngine()
@@ -64,26 +71,30 @@ folHOXEngine::InitGame( const std::string& fen )
         fenStartPosition += " - - 0 1";
     }
 
-    delete _engine;
-	_engine = new folium::Engine();
-	_engine->load(fenStartPosition);
+	_engine->reset(fenStartPosition);
 }
 
 std::string
 folHOXEngine::GenerateMove()
 {
-	std::set<folium::uint> ban;
 	_engine->m_stop = false;
 	_engine->m_depth = std::max(_searchDepth, 5);
-	_engine->m_mintime = folium::now_time() + 1000;
-	_engine->m_maxtime = folium::now_time() + 3000;
-	unsigned int move = _engine->search( ban );
+	_engine->allocate_time();
+	unsigned int move = _engine->search();
 	std::string sNextMove;
 	if (move)
 	{
 		sNextMove = _folium2hox( move );
 		_engine->make_move(move);
 	}
+
+	_searched = true;
+	if ( ! _statsLog.empty() )
+	{
+		std::ofstream log( _statsLog.c_str(), std::ios::app );
+		log << "move=" << ( move ? sNextMove : "none" ) << " "
+		    << _formatStats( " " ) << std::endl;
+	}
 	return sNextMove;
 }
 
@@ -94,6 +105,46 @@ folHOXEngine::OnHumanMove( const std::string& sMove )
 	_engine->make_move(move);
 }
 
+void
+folHOXEngine::SetMoveTime( int nMilliseconds )
+{
+    _engine->m_move_time = std::max( nMilliseconds, 0 );
+}
+
+void
+folHOXEngine::SetTimeControl( int nRemaining,
+                              int nIncrement /* = 0 */,
+                              int nMovesToGo /* = 0 */ )
+{
+    _engine->m_game_time   = std::max( nRemaining, 0 );
+    _engine->m_increment   = std::max( nIncrement, 0 );
+    _engine->m_moves_to_go = std::max( nMovesToGo, 0 );
+}
+
+void
+folHOXEngine::SetThreads( int nThreads )
+{
+    _engine->m_threads = std::min( std::max( nThreads, 1 ), folium::MAX_THREADS );
+}
+
+void
+folHOXEngine::SetStatsLog( const std::string& sPath )
+{
+    _statsLog = sPath;
+}
+
+unsigned long long
+folHOXEngine::Perft( int depth )
+{
+	return _engine->perft( depth );
+}
+
+unsigned long long
+folHOXEngine::GetNodeCount() const
+{
+	return _engine->nodes();
+}
+
 unsigned int
 folHOXEngine::_hox2folium( const std::string& sMove ) const
 {
@@ -121,4 +172,42 @@ folHOXEngine::_folium2hox( unsigned int move ) const
 	return ostr.str();
 }
 
+std::string
+folHOXEngine::GetStats() const
+{
+    return _searched ? _formatStats( "\n" ) : std::string();
+}
+
+std::string
+folHOXEngine::_formatStats( const char* sep ) const
+{
+    const folium::SearchStats s = _engine->stats();
+
+    /* The rates are in percent; the branching factor of each iteration
+     * is its nodes over those of the one before.
+     */
+    std::ostringstream ostr;
+    ostr << std::fixed << std::setprecision(1);
+    ostr << "nodes=" << s.nodes << sep
+         << "qnodes=" << s.qnodes << sep
+         << "time_ms=" << s.time << sep
+         << "nps=" << ( s.time > 0 ? s.nodes * 1000 / s.time : 0 ) << sep
+         << "hash_probes=" << s.hash_probes << sep
+         << "hash_hit_rate=" << ( s.hash_probes ? 100.0 * s.hash_hits / s.hash_probes : 0.0 ) << sep
+         << "hash_cut_rate=" << ( s.hash_probes ? 100.0 * s.hash_cuts / s.hash_probes : 0.0 ) << sep
+         << "hash_move_cuts=" << s.hash_move_cuts << sep
+         << "killer_cuts=" << s.killer_cuts << sep
+         << "null_tries=" << s.null_tries << sep
+         << "null_cut_rate=" << ( s.null_tries ? 100.0 * s.null_cuts / s.null_tries : 0.0 ) << sep
+         << "depth=" << s.iterations.size() << sep
+         << "branching=";
+    ostr << std::setprecision(2);
+    for ( size_t i = 1; i < s.iterations.size(); ++i )
+    {
+        if ( i > 1 ) ostr << ",";
+        ostr << ( s.iterations[i-1] ? double(s.iterations[i]) / s.iterations[i-1] : 0.0 );
+    }
+    return ostr.str();
+}
+
 /************************* END OF FILE ***************************************/
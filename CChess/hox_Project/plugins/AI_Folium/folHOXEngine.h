@@ -44,9 +44,31 @@ public:
     void SetSearchDepth( int searchDepth ) { _searchDepth = searchDepth; }
     int  GetSearchDepth() const { return _searchDepth; }
 
+    void SetMoveTime( int nMilliseconds );
+        /* The most to spend on a move (0 = no limit but the depth). */
+    void SetTimeControl( int nRemaining,
+                         int nIncrement = 0,
+                         int nMovesToGo = 0 );
+        /* The game clock (ms). With it, the time of a move is a share of
+         * the clock left, still within the "move time".
+         */
+    void SetThreads( int nThreads );
+        /* Lazy SMP: the number of threads searching each move. */
+    void SetStatsLog( const std::string& sPath );
+        /* Append the statistics of each search to a file ("" = none). */
+
+    std::string GetStats() const;
+        /* The statistics of the last search, one "name=value" per line
+         * (empty before any search).
+         */
+
+    unsigned long long Perft( int depth );
+    unsigned long long GetNodeCount() const;
+
 private:
     unsigned int _hox2folium( const std::string& sMove ) const;
     std::string _folium2hox( unsigned int move ) const;
+    std::string _formatStats( const char* sep ) const;
 
 private:
 	folium::Engine*       _engine;
@@ -55,6 +77,8 @@ private:
          */
 
     int              _searchDepth;
+    bool             _searched;   // Are there statistics yet?
+    std::string      _statsLog;
 };
 
 #endif /* __INCLUDED_FOL_HOX_ENGINE_H__ */
@@ -354,61 +354,66 @@ namespace folium
     {
         switch (m_stage)
         {
-        case 0:
-            m_stage = 1;
+        case HashStage:
+            m_stage = GenCapsStage;
             if (m_hash_move)
                 return m_hash_move;
-        case 1:
-            m_stage = 2;
+        case GenCapsStage:
+            generate_capture_moves(m_xq, m_caps, m_history);
             m_index = 0;
-            generate_moves(m_xq, m_ml, m_history);
-        case 2:
-            while (m_index < m_ml.size())
+            m_stage = GoodCapsStage;
+        case GoodCapsStage:
+            while (m_index < m_caps.size())
             {
-                uint32 move = m_ml[m_index];
+                uint32 move = m_caps.pick(m_index++);
+                if ((move & 0x3fff) == m_hash_move)
+                    continue;
                 if (is_good_cap(m_xq, move))
-                {
-                    m_ml[m_index] = 0;
-                    m_index++;
                     return move;
-                }
-                m_index++;
+                m_caps[m_bad_caps++] = move;//(a slot already picked)
             }
-            m_stage = 3;
+            m_stage = KillerStage;
             m_index = 0;
-        case 3:
+        case KillerStage:
             while (m_index < 2)
             {
                 uint move = m_killer.killer(m_index);
                 m_index++;
-                if (move &&
+                //only quiet killers: the captures come in their own stages
+                if (move && move != m_hash_move &&
                         m_xq.coordinate_color(move_src(move)) == m_xq.player() &&
+                        m_xq.coordinate_is_empty(move_dst(move)) &&
                         is_legal_move(m_xq, move_src(move), move_dst(move)))
+                {
+                    m_killers[m_index - 1] = move;
                     return move;
+                }
             }
-            m_stage = 4;
+            m_stage = BadCapsStage;
             m_index = 0;
-        case 4:
-            while (m_index < m_ml.size())
+        case BadCapsStage:
+            if (m_index < m_bad_caps)
+                return m_caps[m_index++];
+            m_stage = GenQuietsStage;
+        case GenQuietsStage:
             {
-                uint32 move = m_ml[m_index];
-                if (!move)
+                //all the moves, less the captures and the moves already tried
+                uint size = 0;
+                generate_moves(m_xq, m_quiets, m_history);
+                for (uint i = 0; i < m_quiets.size(); ++i)
                 {
-                    m_index++;
-                    continue;
-                }
-                for (uint j = m_index + 1; j < m_ml.size(); ++j)
-                {
-                    if (m_ml[j] > move)
-                    {
-                        m_ml[m_index] = m_ml[j];
-                        m_ml[j] = move;
-                        move = m_ml[m_index];
-                    }
+                    uint32 move = m_quiets[i];
+                    if (m_xq.coordinate_is_empty(move_dst(move)) && !is_tried(move))
+                        m_quiets[size++] = move;
                 }
-                m_index++;
-                return move;
+                m_quiets.resize(size);
             }
+            m_index = 0;
+            m_stage = QuietsStage;
+        case QuietsStage:
+            if (m_index < m_quiets.size())
+                return m_quiets.pick(m_index++);
+            m_stage = DoneStage;
         }
         return 0;
     }
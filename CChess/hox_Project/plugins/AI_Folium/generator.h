@@ -11,23 +11,48 @@ namespace folium
 {
     extern void generate_moves(const XQ& xq, MoveList &ml, const History& history);
     extern void generate_capture_moves(const XQ& xq, MoveList &ml, const History& history);
+    //gives the moves in stages, each generated and sorted only when needed:
+    //the hash move, the good captures, the killers, the bad captures, and
+    //the quiet moves
     class Generator
     {
     public:
         Generator(XQ& xq, uint32 hash_move, Killer& killer, History& history);
         uint32 next();
     private:
+        enum
+        {
+            HashStage,
+            GenCapsStage,
+            GoodCapsStage,
+            KillerStage,
+            BadCapsStage,
+            GenQuietsStage,
+            QuietsStage,
+            DoneStage
+        };
+        bool is_tried(uint32 move)const;
         XQ& m_xq;
         uint32 m_hash_move;
         Killer& m_killer;
         History& m_history;
-        MoveList m_ml;
+        MoveList m_caps;//the bad captures are kept at the front
+        MoveList m_quiets;
+        uint32 m_killers[2];//the killers tried
         int m_stage;
         uint m_index;
+        uint m_bad_caps;
     };
     inline Generator::Generator(XQ& xq, uint32 hash_move, Killer& killer, History& history):
-            m_xq(xq), m_hash_move(hash_move), m_killer(killer), m_history(history), m_stage(0), m_index(0)
+            m_xq(xq), m_hash_move(hash_move & 0x3fff), m_killer(killer), m_history(history), m_stage(HashStage), m_index(0), m_bad_caps(0)
     {
+        m_killers[0] = m_killers[1] = 0;
+    }
+    //was the (quiet) move already given as the hash move or a killer?
+    inline bool Generator::is_tried(uint32 move)const
+    {
+        move &= 0x3fff;
+        return move == m_hash_move || move == m_killers[0] || move == m_killers[1];
     }
 
 }//namespace folium
@@ -2,7 +2,8 @@
 
 namespace folium
 {
-    HashTable::HashTable(uint32 power)
+    HashTable::HashTable(uint32 power):
+        m_generation(1)
     {
         m_size = 1 << (power -  1);
         m_mask = m_size - 1;
@@ -16,11 +17,14 @@ namespace folium
         delete[] m_records[1];
     }
 
-    void HashTable::clear()
+    void HashTable::resize(uint32 power)
     {
-        for (uint i = 0; i < 2; ++i)
-            for (uint j = 0; j < m_size; ++j)
-                m_records[i][j].clear();
+        delete[] m_records[0];
+        delete[] m_records[1];
+        m_size = 1 << (power -  1);
+        m_mask = m_size - 1;
+        m_records[0] = new Record[m_size];
+        m_records[1] = new Record[m_size];
     }
 
 }//namespace folium
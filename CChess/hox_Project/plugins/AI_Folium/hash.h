@@ -1,6 +1,8 @@
 #ifndef _HASH_H_
 #define _HASH_H_
 
+#include <atomic>
+
 #include "defines.h"
 #include "xq.h"
 
@@ -20,61 +22,98 @@ namespace folium
     {
     public:
         Record();
-        void clear();
         int probe(XQ& xq, int depth, int ply, int alpha, int beta, uint32& move, const uint64& lock);
-        void store_beta(int depth, int ply, int score, uint32 move, const uint64 &lock);
-        void store_alpha(int depth, int ply, int score, uint32 move, const uint64 &lock);
-        void store_pv(int depth, int ply, int score, uint32 move, const uint64 &lock);
+        void store_beta(int depth, int ply, int score, uint32 move, const uint64 &lock, uint generation);
+        void store_alpha(int depth, int ply, int score, uint32 move, const uint64 &lock, uint generation);
+        void store_pv(int depth, int ply, int score, uint32 move, const uint64 &lock, uint generation);
     private:
-        uint64 m_lock;
-        sint8 m_depth;
-        sint8 m_flag;
-        uint16 m_move;
-        sint32 m_score;
+        bool replaceable(int depth, uint generation)const;
+        void store(int depth, uint flag, int score, uint32 move, const uint64 &lock, uint generation);
+        static int data_depth(uint64 data);
+        static uint data_flag(uint64 data);//ALPHA, BETA or PV, | the search generation << 2
+        static uint32 data_move(uint64 data);
+        static int data_score(uint64 data);
+        //the search threads share the records without a lock: the lock is
+        //kept xor-ed with the data, so that a record torn by two writers
+        //fails the lock check, and is a miss
+        std::atomic<uint64> m_check;
+        std::atomic<uint64> m_data;//the score, the move, the depth and the flag
 
     };
-    inline Record::Record():m_flag(0)
+    inline Record::Record():m_check(0), m_data(0)
+    {
+    }
+    inline int Record::data_depth(uint64 data)
+    {
+        return static_cast<sint8>(data >> 48);
+    }
+    inline uint Record::data_flag(uint64 data)
+    {
+        return static_cast<uint>(data >> 56);
+    }
+    inline uint32 Record::data_move(uint64 data)
+    {
+        return static_cast<uint32>(data >> 32) & 0xffff;
+    }
+    inline int Record::data_score(uint64 data)
     {
+        return static_cast<sint32>(data & 0xffffffff);
     }
-    inline void Record::clear()
+    //an entry of an earlier search always gives way, one of this search
+    //only to an entry at least as deep
+    inline bool Record::replaceable(int depth, uint generation)const
     {
-        m_flag = m_flag > PV ? m_flag & PV : 0;
+        uint64 data = m_data.load(std::memory_order_relaxed);
+        return (data_flag(data) >> 2) != generation || data_depth(data) <= depth;
+    }
+    inline void Record::store(int depth, uint flag, int score, uint32 move, const uint64 &lock, uint generation)
+    {
+        uint64 data = static_cast<uint32>(score)
+                      | (static_cast<uint64>(move & 0xffff) << 32)
+                      | (static_cast<uint64>(static_cast<uint8>(depth)) << 48)
+                      | (static_cast<uint64>(flag | (generation << 2)) << 56);
+        m_data.store(data, std::memory_order_relaxed);
+        m_check.store(lock ^ data, std::memory_order_relaxed);
     }
     inline int Record::probe(XQ& xq, int depth, int ply, int alpha, int beta, uint32& move, const uint64& lock)
     {
-        if ((m_flag & PV) != 0 && m_lock == lock && is_legal_move(xq, move_src(m_move), move_dst(m_move)))
+        uint64 data = m_data.load(std::memory_order_relaxed);
+        uint64 check = m_check.load(std::memory_order_relaxed);
+        uint32 record_move = data_move(data);
+        if ((data_flag(data) & PV) != 0 && (check ^ data) == lock && is_legal_move(xq, move_src(record_move), move_dst(record_move)))
         {
-            move = m_move;
-            if (m_score == INVAILDVALUE)
+            int score = data_score(data);
+            move = record_move;
+            if (score == INVAILDVALUE)
             {
                 return INVAILDVALUE;
             }
-            if (m_score > MATEVALUE)
+            if (score > MATEVALUE)
             {
-                return m_score - ply;
+                return score - ply;
             }
-            if (m_score < -MATEVALUE)
+            if (score < -MATEVALUE)
             {
-                return m_score + ply;
+                return score + ply;
             }
-            if (m_depth >= depth)
+            if (data_depth(data) >= depth)
             {
-                switch (m_flag & PV)
+                switch (data_flag(data) & PV)
                 {
                 case ALPHA:
-                    if (m_score <= alpha)
+                    if (score <= alpha)
                     {
-                        return m_score;
+                        return score;
                     }
                     break;
                 case BETA:
-                    if (m_score >= beta)
+                    if (score >= beta)
                     {
-                        return m_score;
+                        return score;
                     }
                     break;
                 case PV:
-                    return m_score;
+                    return score;
                 }
             }
         }
@@ -84,9 +123,9 @@ namespace folium
         }
         return INVAILDVALUE;
     }
-    inline void Record::store_alpha(int depth, int ply, int score, uint32 move, const uint64 &lock)
+    inline void Record::store_alpha(int depth, int ply, int score, uint32 move, const uint64 &lock, uint generation)
     {
-        if ((m_flag > PV) && m_depth > depth)
+        if (!replaceable(depth, generation))
         {
             return;
         }
@@ -98,15 +137,11 @@ namespace folium
         {
             score -= ply;
         }
-        m_lock = lock;
-        m_depth = depth;
-        m_flag = ALPHA | 4;
-        m_move = (uint16) move;
-        m_score = score;
+        store(depth, ALPHA, score, move, lock, generation);
     }
-    inline void Record::store_beta(int depth, int ply, int score, uint32 move, const uint64 &lock)
+    inline void Record::store_beta(int depth, int ply, int score, uint32 move, const uint64 &lock, uint generation)
     {
-        if ((m_flag > PV) && m_depth > depth)
+        if (!replaceable(depth, generation))
         {
             return;
         }
@@ -118,15 +153,11 @@ namespace folium
         {
             score += ply;
         }
-        m_lock = lock;
-        m_depth = depth;
-        m_flag = BETA | 4;
-        m_move = (uint16) move;
-        m_score = score;
+        store(depth, BETA, score, move, lock, generation);
     }
-    inline void Record::store_pv(int depth, int ply, int score, uint32 move, const uint64 &lock)
+    inline void Record::store_pv(int depth, int ply, int score, uint32 move, const uint64 &lock, uint generation)
     {
-        if ((m_flag > PV) && m_depth > depth)
+        if (!replaceable(depth, generation))
         {
             return;
         }
@@ -142,25 +173,34 @@ namespace folium
         {
             score -= ply;
         }
-        m_lock = lock;
-        m_depth = depth;
-        m_flag = PV | 4;
-        m_move = (uint16) move;
-        m_score = score;
+        store(depth, PV, score, move, lock, generation);
     }
     class HashTable
     {
     public:
         HashTable(uint32 power=22);
         ~HashTable();
-        void clear();
+        void resize(uint32 power);//2^power records, all empty
+        void new_search();//ages all the entries, in O(1)
+        uint generation()const;
         Record& record(const uint32 &key, uint player);
     private:
         uint32 m_size;
         uint32 m_mask;
+        uint32 m_generation;//1-63, so that an empty record is never current
         Record* m_records[2];
     };
 
+    inline void HashTable::new_search()
+    {
+        m_generation = m_generation % 63 + 1;
+    }
+
+    inline uint HashTable::generation()const
+    {
+        return m_generation;
+    }
+
     inline Record& HashTable::record(const uint32 &key, uint player)
     {
         return m_records[player][key & m_mask];
@@ -37,28 +37,34 @@ namespace folium
     static const char _target_1[] = "ihgfedcba0123456789";
     static const char _origin_2[] = "abcdefghi0123456789";
     static const char _target_2[] = "ihgfedcba9876543210";
-    static map<char, char> _m1_map;
-    static map<char, char> _m2_map;
+    static map<char, char> create_mirror_map(const char* origin, const char* target)
+    {
+        map<char, char> _map;
+        for (unsigned int i = 0; origin[i]; ++i)
+            _map[origin[i]] = target[i];
+        return _map;
+    }
+    //built when the library is loaded, so that engines can share them
+    static const map<char, char> _m1_map = create_mirror_map(_origin_1, _target_1);
+    static const map<char, char> _m2_map = create_mirror_map(_origin_2, _target_2);
+    static char mirror_char(const map<char, char>& _map, char c)
+    {
+        map<char, char>::const_iterator itr = _map.find(c);
+        return itr != _map.end() ? itr->second : '\0';
+    }
     string mirror4uccimove(const string& ucci, uint mirror)
     {
-        if (_m1_map.empty())
-        {
-            for (unsigned int i = 0; i < (sizeof(_origin_1) / sizeof(_origin_1[0])); ++i)
-            _m1_map[_origin_1[i]] = _target_1[i];
-            for (unsigned int i = 0; i < (sizeof(_origin_2) / sizeof(_origin_2[0])); ++i)
-                _m2_map[_origin_2[i]] = _target_2[i];
-        }
         assert(mirror < 4);
         string ret = ucci;
         if (mirror & 1)
         {
             for (string::iterator itr = ret.begin(); itr != ret.end(); ++itr)
-                *itr = _m1_map[*itr];
+                *itr = mirror_char(_m1_map, *itr);
         }
         if (mirror & 2)
         {
             for (string::iterator itr = ret.begin(); itr != ret.end(); ++itr)
-                *itr = _m2_map[*itr];
+                *itr = mirror_char(_m2_map, *itr);
         }
         return ret;
     }
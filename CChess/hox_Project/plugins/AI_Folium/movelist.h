@@ -16,10 +16,12 @@ namespace folium
         MoveList();
         uint size()const;
         void clear();
+        void resize(uint size);//(only to shrink)
         uint32& operator[](uint32 index);
         const uint32& operator[](uint32 index)const;
         void push(uint src, uint dst);
         void push(uint32 move);
+        uint32 pick(uint index);
     };
     inline MoveList::MoveList():length(0) {}
     inline uint MoveList::size()const
@@ -30,6 +32,10 @@ namespace folium
     {
         length = 0;
     }
+    inline void MoveList::resize(uint size)
+    {
+        length = size;
+    }
     inline uint32& MoveList::operator[](uint32 index)
     {
         return movelist[index];
@@ -46,6 +52,21 @@ namespace folium
     {
         movelist[length++] = move;
     }
+    //moves the best (highest scored) of the moves from index on to index,
+    //and returns it: a sort done lazily, as far as the moves are tried
+    inline uint32 MoveList::pick(uint index)
+    {
+        uint best = index;
+        for (uint i = index + 1; i < length; ++i)
+        {
+            if (movelist[i] > movelist[best])
+                best = i;
+        }
+        uint32 move = movelist[best];
+        movelist[best] = movelist[index];
+        movelist[index] = move;
+        return move;
+    }
 
 }//namespace folium
 
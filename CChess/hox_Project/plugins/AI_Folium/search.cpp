@@ -5,10 +5,8 @@
 using namespace std;
 namespace folium
 {
-    const int LIMIT_DEPTH = 64;
     const int NULL_DEPTH = 2;
 
-    static Killer killers[LIMIT_DEPTH+1];
     int Engine::full(int depth, int alpha, int beta)
     {
         ++m_tree_nodes;
@@ -45,10 +43,13 @@ namespace folium
             return leaf(alpha, beta);
         }
 
-        Record& record = m_hash.record(m_keys[m_ply], m_xq.player());
+        Record& record = m_hash->record(m_keys[m_ply], m_xq.player());
         uint32 hash_move;
         {
             int score = record.probe(m_xq, depth, ply, alpha, beta, hash_move, m_locks[m_ply]);
+            ++m_hash_probes;
+            if (hash_move)
+                ++m_hash_hits;
             if (score != INVAILDVALUE)
             {
                 m_hash_hit_nodes++;
@@ -57,8 +58,8 @@ namespace folium
         }
 
         uint32 best_move=0;
-        Killer& killer=killers[ply];
-        killers[ply+1].clear();
+        Killer& killer=m_killers[ply];
+        m_killers[ply+1].clear();
         MoveList ml;
 
 
@@ -102,8 +103,14 @@ namespace folium
                 {
                     if (is_stop())
                         return - WINSCORE;
+                    if (best_move == (hash_move & 0x3fff))
+                        ++m_hash_move_cuts;
+                    else if (best_move == killer.killer(0))
+                        ++m_kill_cuts_1;
+                    else if (best_move == killer.killer(1))
+                        ++m_kill_cuts_2;
                     m_history.update_history(best_move, depth);
-                    record.store_beta(depth, ply, score, best_move, m_locks[m_ply]);
+                    record.store_beta(depth, ply, score, best_move, m_locks[m_ply], m_hash->generation());
                     if (!is_good_cap(m_xq, best_move))
                         killer.push(best_move);
                     return score;
@@ -122,9 +129,9 @@ namespace folium
             killer.push(best_move);
             m_history.update_history(best_move, depth);
             if (!found)
-                record.store_alpha(depth, ply, best_value, best_move, m_locks[m_ply]);
+                record.store_alpha(depth, ply, best_value, best_move, m_locks[m_ply], m_hash->generation());
             else
-                record.store_pv(depth, ply, best_value, best_move, m_locks[m_ply]);
+                record.store_pv(depth, ply, best_value, best_move, m_locks[m_ply], m_hash->generation());
         }
         return best_value;
     }
@@ -144,16 +151,7 @@ namespace folium
         uint size = ml.size();
         for (uint i = 0; i < size; ++i)
         {
-            uint32 move = ml[i];
-            for (uint j = i + 1; j < size; ++j)
-            {
-                if (ml[j] > move)
-                {
-                    ml[i] = ml[j];
-                    ml[j] = move;
-                    move = ml[i];
-                }
-            }
+            uint32 move = ml.pick(i);
             if (!make_move(move))
                 continue;
             int score = - quies(-beta, -alpha);
@@ -211,16 +209,7 @@ namespace folium
         uint size = ml.size();
         for (uint i = 0; i < size; ++i)
         {
-            uint32 move = ml[i];
-            for (uint j = i + 1; j < size; ++j)
-            {
-                if (ml[j] > move)
-                {
-                    ml[i] = ml[j];
-                    ml[j] = move;
-                    move = ml[i];
-                }
-            }
+            uint32 move = ml.pick(i);
             if (!make_move(move))
                 continue;
             score = - quies(-beta, -alpha);
@@ -0,0 +1,299 @@
+//folium-ucci: the Folium engine as a process of its own, talking the UCCI
+//protocol over stdin/stdout (all the times are in ms)
+#include "engine.h"
+#include "move_helper.h"
+#include "utility/str.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace folium
+{
+    using std::vector;
+
+    const char* const START_FEN = "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1";
+
+    class UCCIEngine : public Engine
+    {
+    public:
+        UCCIEngine();
+        virtual bool readable();
+        virtual bool writable() {return true;}
+        virtual string readline();
+        virtual void writeline(const string& str);
+        void run();
+    private:
+        bool input_ready();//without blocking
+        void read_input();//blocks until some input (or its end) comes
+        void position(const vector<string>& args);
+        void banmoves(const vector<string>& args);
+        void go(const vector<string>& args);
+        string m_input;//read, but not yet taken
+        bool m_eof;
+        bool m_searching;
+        bool m_quit;//"quit" came, maybe during a search
+        MoveSet m_ban;
+    };
+
+    UCCIEngine::UCCIEngine():
+        m_eof(false),
+        m_searching(false),
+        m_quit(false)
+    {
+    }
+
+    bool UCCIEngine::input_ready()
+    {
+#ifdef _WIN32
+        HANDLE handle = GetStdHandle(STD_INPUT_HANDLE);
+        DWORD avail = 0;
+        if (PeekNamedPipe(handle, NULL, 0, NULL, &avail, NULL))
+            return avail > 0;
+        return WaitForSingleObject(handle, 0) == WAIT_OBJECT_0;//a console
+#else
+        pollfd fd;
+        fd.fd = 0;
+        fd.events = POLLIN;
+        fd.revents = 0;
+        return poll(&fd, 1, 0) > 0;
+#endif
+    }
+
+    void UCCIEngine::read_input()
+    {
+        char buf[4096];
+#ifdef _WIN32
+        int n = _read(0, buf, sizeof(buf));
+#else
+        int n = static_cast<int>(::read(0, buf, sizeof(buf)));
+#endif
+        if (n <= 0)
+            m_eof = true;
+        else
+            m_input.append(buf, n);
+    }
+
+    //during a search, only the commands for a search are taken: the others
+    //wait for it to end
+    bool UCCIEngine::readable()
+    {
+        string::size_type end = m_input.find('\n');
+        if (end == string::npos && !m_eof && input_ready())
+        {
+            read_input();
+            end = m_input.find('\n');
+        }
+        if (end == string::npos)
+            return m_eof;
+        if (!m_searching)
+            return true;
+        string line = trim(m_input.substr(0, end));
+        return line == "isready" || line == "stop" || line == "ponderhit" || line == "quit";
+    }
+
+    //the end of the input counts as "quit"
+    string UCCIEngine::readline()
+    {
+        string::size_type end;
+        while ((end = m_input.find('\n')) == string::npos && !m_eof)
+            read_input();
+        string line;
+        if (end == string::npos)
+        {
+            line = m_input.empty() ? "quit" : m_input;
+            m_input.clear();
+        }
+        else
+        {
+            line = m_input.substr(0, end);
+            m_input.erase(0, end + 1);
+        }
+        line = trim(line);
+        if (line == "quit")
+            m_quit = true;
+        return line;
+    }
+
+    void UCCIEngine::writeline(const string& str)
+    {
+        std::cout << str << std::endl;
+    }
+
+    static vector<string> words(const string& line)
+    {
+        vector<string> r;
+        std::istringstream in(line);
+        string word;
+        while (in >> word)
+            r.push_back(word);
+        return r;
+    }
+
+    static uint32 parse_move(const string& ucci)
+    {
+        return ucci.size() == 4 ? ucci2move(ucci) : 0;
+    }
+
+    //position {fen <fen> | startpos} [moves <move> ...]
+    void UCCIEngine::position(const vector<string>& args)
+    {
+        uint i = 1;
+        string fen = START_FEN;
+        if (i < args.size() && args[i] == "fen")
+        {
+            vector<string> fields;
+            for (++i; i < args.size() && args[i] != "moves"; ++i)
+                fields.push_back(args[i]);
+            fen = join(fields, " ");
+        }
+        else if (i < args.size() && args[i] == "startpos")
+            ++i;
+        m_ban.reset();
+        if (!load(fen))
+        {
+            load(START_FEN);
+            return;
+        }
+        if (i < args.size() && args[i] == "moves")
+        {
+            //the moves after an illegal one are dropped with it
+            for (++i; i < args.size(); ++i)
+            {
+                uint32 move = parse_move(args[i]);
+                if (!move || !play(move))
+                    break;
+            }
+        }
+    }
+
+    //banmoves <move> ...: the moves the next search must not choose
+    void UCCIEngine::banmoves(const vector<string>& args)
+    {
+        m_ban.reset();
+        for (uint i = 1; i < args.size(); ++i)
+        {
+            uint32 move = parse_move(args[i]);
+            if (move)
+                m_ban.set(move);
+        }
+    }
+
+    //go [ponder] [depth <d> | infinite | time <t> [increment <i>]
+    //  [movestogo <m>]]: with neither a depth nor a time, it searches until
+    //"stop", and a pondering search waits for "ponderhit" or "stop" before
+    //it answers
+    void UCCIEngine::go(const vector<string>& args)
+    {
+        bool infinite = false;
+        m_ponder = false;
+        m_depth = LIMIT_DEPTH;
+        m_game_time = 0;
+        m_increment = 0;
+        m_moves_to_go = 0;
+        m_move_time = 0;
+        for (uint i = 1; i < args.size(); ++i)
+        {
+            const string& arg = args[i];
+            int value = i + 1 < args.size() ? std::atoi(args[i + 1].c_str()) : 0;
+            if (arg == "ponder")
+                m_ponder = true;
+            else if (arg == "infinite")
+                infinite = true;
+            else if (arg == "depth")
+                m_depth = std::max(1, std::min(value, LIMIT_DEPTH - 1)) + 1;//searches depths < m_depth
+            else if (arg == "time")
+                m_game_time = std::max(value, 0);
+            else if (arg == "increment")
+                m_increment = std::max(value, 0);
+            else if (arg == "movestogo")
+                m_moves_to_go = std::max(value, 0);
+            else if (arg == "opptime" || arg == "oppincrement" || arg == "oppmovestogo")
+                ;
+            else
+                continue;
+            if (arg != "ponder" && arg != "infinite")
+                ++i;
+        }
+        if (infinite)
+            m_game_time = 0;
+
+        m_stop = false;
+        allocate_time();
+        m_searching = true;
+        uint32 move = search(m_ban);
+        m_searching = false;
+        m_ban.reset();
+        while ((infinite || m_ponder) && !m_stop && !m_quit)
+        {
+            string line = readline();
+            if (line == "isready")
+                writeline("readyok");
+            else if (line == "stop" || line == "ponderhit")
+                m_stop = true;
+        }
+        m_ponder = false;
+        writeline(move ? "bestmove " + move2ucci(move) : string("nobestmove"));
+    }
+
+    void UCCIEngine::run()
+    {
+        while (!m_quit)
+        {
+            vector<string> args = words(readline());
+            if (args.empty())
+                continue;
+            const string& cmd = args[0];
+            if (cmd == "ucci")
+            {
+                writeline("id name Folium");
+                writeline("id author Wangmao Lin");
+                writeline("option hashsize type spin min 1 max 1024 default 32");
+                writeline("option threads type spin min 1 max 64 default 1");
+                writeline("ucciok");
+            }
+            else if (cmd == "isready")
+                writeline("readyok");
+            else if (cmd == "setoption")
+            {
+                //setoption <name> <value>, or setoption name <name> value <value>
+                vector<string> opt;
+                for (uint i = 1; i < args.size(); ++i)
+                    if (args[i] != "name" && args[i] != "value")
+                        opt.push_back(args[i]);
+                if (opt.size() == 2 && opt[0] == "hashsize")
+                    set_hash_size(std::max(std::atoi(opt[1].c_str()), 1));
+                else if (opt.size() == 2 && opt[0] == "threads")
+                    m_threads = std::max(1, std::min(std::atoi(opt[1].c_str()), MAX_THREADS));
+            }
+            else if (cmd == "position")
+                position(args);
+            else if (cmd == "banmoves")
+                banmoves(args);
+            else if (cmd == "go")
+                go(args);
+            else if (cmd == "quit")
+                break;
+            //"stop" and "ponderhit" with no search on are ignored
+        }
+        writeline("bye");
+    }
+}//namespace folium
+
+int main()
+{
+    folium::UCCIEngine engine;
+    engine.run();
+    return 0;
+}
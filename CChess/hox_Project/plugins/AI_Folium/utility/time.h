@@ -3,7 +3,9 @@
 
 namespace folium
 {
-    double now_time();
+    //milliseconds since an arbitrary point, from a monotonic clock: only
+    //differences between two readings mean something
+    long long now_time();
 }
 
 #endif //FOLIUM_TIME_H
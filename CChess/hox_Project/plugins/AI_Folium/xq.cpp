@@ -28,60 +28,68 @@ namespace folium
         m_player = Empty;
     }
 
-    static uint char_type(sint32 c)
+    //the maps are built when the library is loaded: filling them on first
+    //use is not safe when several engines start at the same time
+    static map<sint, uint> create_char_type_map()
     {
-        static map<sint, uint> _map;
-        if (_map.empty())
-        {
-            _map['K'] = RedKing;
-            _map['G'] = RedAdvisor;
-            _map['A'] = RedAdvisor;
-            _map['B'] = RedBishop;
-            _map['E'] = RedBishop;
-            _map['R'] = RedRook;
-            _map['H'] = RedKnight;
-            _map['N'] = RedKnight;
-            _map['C'] = RedCannon;
-            _map['P'] = RedPawn;
+        map<sint, uint> _map;
+        _map['K'] = RedKing;
+        _map['G'] = RedAdvisor;
+        _map['A'] = RedAdvisor;
+        _map['B'] = RedBishop;
+        _map['E'] = RedBishop;
+        _map['R'] = RedRook;
+        _map['H'] = RedKnight;
+        _map['N'] = RedKnight;
+        _map['C'] = RedCannon;
+        _map['P'] = RedPawn;
 
-            _map['k'] = BlackKing;
-            _map['g'] = BlackAdvisor;
-            _map['a'] = BlackAdvisor;
-            _map['b'] = BlackBishop;
-            _map['e'] = BlackBishop;
-            _map['r'] = BlackRook;
-            _map['h'] = BlackKnight;
-            _map['n'] = BlackKnight;
-            _map['c'] = BlackCannon;
-            _map['p'] = BlackPawn;
-        }
-        if (_map.find(c) != _map.end())
-            return _map[c];
+        _map['k'] = BlackKing;
+        _map['g'] = BlackAdvisor;
+        _map['a'] = BlackAdvisor;
+        _map['b'] = BlackBishop;
+        _map['e'] = BlackBishop;
+        _map['r'] = BlackRook;
+        _map['h'] = BlackKnight;
+        _map['n'] = BlackKnight;
+        _map['c'] = BlackCannon;
+        _map['p'] = BlackPawn;
+        return _map;
+    }
+    static const map<sint, uint> s_char_types = create_char_type_map();
+    static uint char_type(sint32 c)
+    {
+        map<sint, uint>::const_iterator itr = s_char_types.find(c);
+        if (itr != s_char_types.end())
+            return itr->second;
         return InvaildPiece;
     }
-    static sint type_char(uint32 t)
+    static map<uint, sint> create_type_char_map()
     {
-        static map<uint, sint> _map;
-        if (_map.empty())
-        {
-            _map[RedKing] = 'K';
-            _map[RedAdvisor] = 'A';
-            _map[RedBishop] = 'B';
-            _map[RedRook] = 'R';
-            _map[RedKnight] = 'N';
-            _map[RedCannon] = 'C';
-            _map[RedPawn] = 'P';
+        map<uint, sint> _map;
+        _map[RedKing] = 'K';
+        _map[RedAdvisor] = 'A';
+        _map[RedBishop] = 'B';
+        _map[RedRook] = 'R';
+        _map[RedKnight] = 'N';
+        _map[RedCannon] = 'C';
+        _map[RedPawn] = 'P';
 
-            _map[BlackKing] = 'k';
-            _map[BlackAdvisor] = 'a';
-            _map[BlackBishop] = 'b';
-            _map[BlackRook] = 'r';
-            _map[BlackKnight] = 'n';
-            _map[BlackCannon] = 'c';
-            _map[BlackPawn] = 'p';
-        }
-        if (_map.find(t) != _map.end())
-            return _map[t];
+        _map[BlackKing] = 'k';
+        _map[BlackAdvisor] = 'a';
+        _map[BlackBishop] = 'b';
+        _map[BlackRook] = 'r';
+        _map[BlackKnight] = 'n';
+        _map[BlackCannon] = 'c';
+        _map[BlackPawn] = 'p';
+        return _map;
+    }
+    static const map<uint, sint> s_type_chars = create_type_char_map();
+    static sint type_char(uint32 t)
+    {
+        map<uint, sint>::const_iterator itr = s_type_chars.find(t);
+        if (itr != s_type_chars.end())
+            return itr->second;
         return 0;
     }
     static sint piece_char(uint piece)
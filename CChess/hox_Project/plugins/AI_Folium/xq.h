@@ -30,7 +30,9 @@ namespace folium
 
         uint32 player()const;
 
-        bool do_move(uint, uint);
+        bool do_move(uint, uint, bool verify = true);//verify: refuse a self-check
+        bool may_expose(uint, uint)const;//before a move
+        bool may_check(uint, uint)const;//after a move
         void undo_move(uint, uint, uint);
         void do_null();
         void undo_null();
@@ -142,7 +144,38 @@ namespace folium
         return m_bitmap.distance_is_1(src, dst);
     }
 
-    inline bool XQ::do_move(uint src, uint dst)
+    //a move can put (or leave) its own king in check only if the king is
+    //in check already (which the caller knows), if it is the king's, or if
+    //it leaves the king's rank or file (a rook, cannon or king line) or a
+    //square next to it (a knight's leg), or enters the rank or file (as a
+    //cannon screen): for any other move, do_move need not look
+    inline bool XQ::may_expose(uint src, uint dst)const
+    {
+        uint kp = piece(m_player == Red ? RedKingIndex : BlackKingIndex);
+        uint kx = coordinate_x(kp);
+        uint ky = coordinate_y(kp);
+        uint sx = coordinate_x(src);
+        uint sy = coordinate_y(src);
+        return sx == kx || sy == ky
+               || (sx + 1 - kx <= 2 && sy + 1 - ky <= 2)
+               || coordinate_x(dst) == kx || coordinate_y(dst) == ky;
+    }
+    //likewise, the move just made can have checked the player to move only
+    //from or to those squares of its king, or with a knight
+    inline bool XQ::may_check(uint src, uint dst)const
+    {
+        uint kp = piece(m_player == Red ? RedKingIndex : BlackKingIndex);
+        uint kx = coordinate_x(kp);
+        uint ky = coordinate_y(kp);
+        uint sx = coordinate_x(src);
+        uint sy = coordinate_y(src);
+        return sx == kx || sy == ky
+               || (sx + 1 - kx <= 2 && sy + 1 - ky <= 2)
+               || coordinate_x(dst) == kx || coordinate_y(dst) == ky
+               || ((coordinate_flag(dst) & KnightFlag) && knight_leg(dst, kp) != InvaildCoordinate);
+    }
+
+    inline bool XQ::do_move(uint src, uint dst, bool verify)
     {
         uint32 src_piece = coordinate(src);
         uint32 dst_piece = coordinate(dst);
@@ -155,7 +188,7 @@ namespace folium
         m_coordinates[dst] = static_cast<uint8>(src_piece);
         m_pieces[src_piece] = static_cast<uint8>(dst);
         m_pieces[dst_piece] = static_cast<uint8>(InvaildCoordinate);
-        if (player_in_check(*this, m_player))
+        if (verify && player_in_check(*this, m_player))
         {
             m_bitmap.undo_move(src, dst, dst_piece);
             m_coordinates[src] = static_cast<uint8>(src_piece);
@@ -40,6 +40,7 @@ extern const char* GenerateNextMove();
 extern void        OnOpponentMove(const char *line);
 extern void        DeInitEngine();
 extern void        SetMaxDepth( int searchDepth );
+extern int         GetNodeCount();
 
 /*
  * AI Engine Implementation
@@ -116,6 +117,12 @@ public:
                "home.hccnet.nl/h.g.muller/XQhaqikid.html";
     }
 
+    int getNodeCount( unsigned long long& nodes )
+    {
+        nodes = ::GetNodeCount();
+        return hoxAI_RC_OK;
+    }
+
 private:
     std::string _hoxToMove( const std::string& sIn );
     std::string _moveToHox( const std::string& sIn );
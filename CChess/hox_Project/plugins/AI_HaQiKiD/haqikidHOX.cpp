@@ -1250,6 +1250,11 @@ void SetMaxDepth( int searchDepth )
     MaxDepth = searchDepth;
 }
 
+int GetNodeCount()
+{
+    return nodeCnt;  /* of the last GenerateNextMove() */
+}
+
 ///////////////// END of Huy Phan's changes //////////////////////////////////
 
 /************************* END OF FILE ***************************************/
@@ -90,6 +90,12 @@ public:
                "home.hccnet.nl/h.g.muller/XQmaxqi.html";
     }
 
+    int getNodeCount( unsigned long long& nodes )
+    {
+        nodes = MaxQi::get_node_count();
+        return hoxAI_RC_OK;
+    }
+
 private:
     std::string m_name;
 
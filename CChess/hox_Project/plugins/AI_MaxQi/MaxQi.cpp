@@ -32,6 +32,7 @@ int MovesLeft;
 int Fifty;
 int PlyNr;
 int Ticks, tlim;
+int Nodes;              /* nodes searched for the last move         */
 
 #define W while
 #define K(A,B) *(int*)(T+A+((B&31)<<8))
@@ -240,6 +241,7 @@ const char *_GenerateNextMove()
  N=0;K=I;
  if (D(Side,-I,I,Q,S,3)!=I) sprintf(move, "none"); /* no move found */ else
  {/* legal move was found and played */
+  Nodes = N;  /* (before N is reused for the time used)   */
   Side ^= 16; /* other side moves next */
   //sprintf(move, "%c%c%c%c",'i'-(K>>4),'9'-(K&15),'i'-(L>>4&15),'9'-(L&15));
   sprintf(move, "%d%d%d%d",(K>>4),(K&15),(L>>4&15),(L&15));
@@ -298,4 +300,10 @@ MaxQi::set_max_depth( int searchDepth )
     MaxDepth = searchDepth;
 }
 
+int
+MaxQi::get_node_count()
+{
+    return Nodes;
+}
+
 /************************* END OF FILE ***************************************/
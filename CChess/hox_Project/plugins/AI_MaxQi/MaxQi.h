@@ -31,6 +31,7 @@ namespace MaxQi
     std::string generate_move();
     void        on_human_move( const std::string& sMove );
     void        set_max_depth( int searchDepth );
+    int         get_node_count();  /* of the last generate_move() */
 
 } // namespace MaxQi
 
@@ -29,6 +29,7 @@
 
 #include <AIEngineLib.h>
 #include <DefaultDelete.h>
+#include <cstdlib>
 #include <memory>
 #include "Move.h"
 #include "Board.h"
@@ -41,6 +42,7 @@ class AIEngineImpl : public DefaultDelete<AIEngineLib>
 public:
     AIEngineImpl( const char* engineName )
         : m_name( engineName ? engineName : "__UNKNOWN__" )
+        , m_hashSize( 0 )
     {
     }
 
@@ -65,6 +67,10 @@ public:
         m_lawyer.reset( new Lawyer( m_board.get() ) );
         m_engine.reset( new tsiEngine( m_board.get(),
                                        m_lawyer.get() ) );
+        if ( m_hashSize > 0 )
+        {
+            m_engine->setHashSize( m_hashSize );
+        }
         return hoxAI_RC_OK;
     }
 
@@ -116,6 +122,38 @@ public:
                "xiangqi-engine.sourceforge.net";
     }
 
+    int setOption( const std::string& name,
+                   const std::string& value )
+    {
+        if ( name == "Hash" )  // In MB.
+        {
+            m_hashSize = ::atoi( value.c_str() );
+            if ( m_engine.get() != NULL && m_hashSize > 0 )
+            {
+                m_engine->setHashSize( m_hashSize );
+            }
+            return hoxAI_RC_OK;
+        }
+        return hoxAI_RC_NOT_SUPPORTED;
+    }
+
+    int perft( int                 depth,
+               unsigned long long& nodes )
+    {
+        if ( m_engine.get() == NULL ) return hoxAI_RC_ERR;
+
+        nodes = m_engine->perft( depth );
+        return hoxAI_RC_OK;
+    }
+
+    int getNodeCount( unsigned long long& nodes )
+    {
+        if ( m_engine.get() == NULL ) return hoxAI_RC_ERR;
+
+        nodes = m_engine->nodes();
+        return hoxAI_RC_OK;
+    }
+
 private:
     Move _translateStringToMove( const std::string& sMove )
     {
@@ -151,6 +189,8 @@ private:
     TSITO_Lawyer_APtr   m_lawyer;
     TSITO_Engine_APtr   m_engine;
 
+    int                 m_hashSize;  // In MB, as set by the "Hash" option.
+
 }; /* class AIEngineImpl */
 
 
@@ -39,6 +39,7 @@ bool Board::hashValuesFilled = false;
 Board::Board()
 {
   _primaryHash = _secondaryHash = 0;
+  _searching = false;
   if (!hashValuesFilled)
     {
       generateValues();
@@ -49,6 +50,7 @@ Board::Board()
 Board::Board(string fen)
 {
   _primaryHash = _secondaryHash = 0;
+  _searching = false;
   generateValues();
   setPosition(fen);
 }
@@ -79,58 +81,32 @@ void Board::generateValues()
 
 // Piece management
 
-// Removes piece at loc from the appropriate index...
+// Removes piece at loc from the appropriate index: the last piece of the list
+// takes its place.
 void Board::removePiece(int loc)
 {
-  vector<int>::iterator it;
-  vector< vector<int> > *pieces = (colorAt(loc)==RED? &rpieces:&bpieces);
-  for (it = (*pieces)[pieceAt(loc) - 1].begin();
-       it != (*pieces)[pieceAt(loc) - 1].end();
-       it++)
-    if (*it == loc)
-      {
-        (*pieces)[pieceAt(loc) - 1].erase(it);
-        break;
-      }
+  int side = (colorAt(loc)==RED? 1:0);
+  int *squares = pieceSquares[side][pieceAt(loc)];
+  int last = squares[--pieceCounts[side][pieceAt(loc)]];
+  squares[pieceIndex[loc]] = last;
+  pieceIndex[last] = pieceIndex[loc];
 }
 
 // Adds the piece at loc to the appropriate index...
 void Board::addPiece(int loc)
 {
-  if (colorAt(loc) == RED)
-    rpieces[pieceAt(loc) - 1].push_back(loc);
-  else
-  bpieces[pieceAt(loc) - 1].push_back(loc);
+  int side = (colorAt(loc)==RED? 1:0);
+  int &count = pieceCounts[side][pieceAt(loc)];
+  pieceSquares[side][pieceAt(loc)][count] = loc;
+  pieceIndex[loc] = count++;
 }
 
 // Move the piece at origin to dest in piece indexes.
 void Board::movePiece(int origin, int dest)
 {
-  vector<int>::iterator it;
-  vector< vector<int> > *pieces = (colorAt(origin)==RED? &rpieces:&bpieces);
-  for (it = (*pieces)[pieceAt(origin) - 1].begin();
-       it != (*pieces)[pieceAt(origin) - 1].end();
-       it++)
-    if (*it == origin)
-      {
-        *it = dest;
-        break;
-      }
-}
-
-// Return the piece index array for the specified color and piece type...
-vector<int> Board::pieces(color c, piece p)
-{
-  if (c == RED)
-    return rpieces[p - 1];
-  else
-    return bpieces[p - 1];
-}
-
-// Set up a piece index vector...
-static void setupVector(vector< vector<int> > &v)
-{
-  for (int i = 0; i < 7; i++) v.push_back(vector<int>());
+  int side = (colorAt(origin)==RED? 1:0);
+  pieceSquares[side][pieceAt(origin)][pieceIndex[origin]] = dest;
+  pieceIndex[dest] = pieceIndex[origin];
 }
 
 // Read fen notation and distribute pieces on board and indexes...
@@ -143,10 +119,9 @@ bool Board::setPosition(string fen)
   char tempBoard[BOARD_AREA];
   int board_i = 0, board_j = 0;
   u_int32 t_primaryHash = 0, t_secondaryHash = 0;
-  vector< vector<int> > t_bpieces;
-  vector< vector<int> > t_rpieces;
+  int t_pieceCounts[2][8];
 
-  setupVector(t_rpieces); setupVector(t_bpieces);
+  memset(t_pieceCounts, 0, sizeof(t_pieceCounts));
 
   // Iterate through the fen string as long as we are still on the board.
   while (fen_p != fen.end() && (board_i) * 9 + board_j < BOARD_AREA)
@@ -223,11 +198,9 @@ bool Board::setPosition(string fen)
           t_primaryHash ^= hashValues[0][row+board_j][(size_t)tempBoard[row+board_j]];
           t_secondaryHash ^= hashValues[1][row+board_j][(size_t)tempBoard[row+board_j]];
 
-          // Add the piece to the piece index tables...
-          if ((tempBoard[row+board_j]&8) == RED)
-            t_rpieces[(tempBoard[row+board_j]&7) - 1].push_back(row+board_j);
-          else if ((tempBoard[row+board_j]&8) == BLUE)
-            t_bpieces[(tempBoard[row+board_j]&7) - 1].push_back(row+board_j);
+          // Count the piece for the piece index tables...
+          if (++t_pieceCounts[(tempBoard[row+board_j]&8) ? 1:0][tempBoard[row+board_j]&7] > MAX_PIECES)
+            return false;
           
           board_j++;
         }
@@ -248,6 +221,7 @@ bool Board::setPosition(string fen)
   // Initialize actual variables with contents of temporaries and clear game tracking variables.
   memcpy(board, tempBoard, BOARD_AREA);
   moveHistory.clear();
+  positionHistory.clear();
   _startPos = fen;
   _gameOver = false;
   _primaryHash = t_primaryHash;
@@ -255,12 +229,9 @@ bool Board::setPosition(string fen)
   u_int32 colorSet = (_sideToMove << 28);
   _primaryHash |= colorSet;
   _secondaryHash |= colorSet;
-  rpieces.clear(); bpieces.clear();
-  for (int i = 0; i < 7; i ++)
-    {
-      rpieces.push_back(t_rpieces[i]);
-      bpieces.push_back(t_bpieces[i]);
-    }
+  memset(pieceCounts, 0, sizeof(pieceCounts));
+  for (int i = 0; i < BOARD_AREA; i++)
+    if (board[i]) addPiece(i);
   notifyObservers(BOARD_ALTERED);
 
   return true; // Return true.
@@ -417,7 +388,8 @@ void Board::makeMove(Move &theMove)
   _sideToMove    ^= RED;
   _primaryHash   ^= COLOR_SWITCH_KEY;
   _secondaryHash ^= COLOR_SWITCH_KEY;
-  notifyObservers(MOVE_MADE);
+  positionHistory.push_back(positionHash(_primaryHash, _secondaryHash));
+  if (!_searching) notifyObservers(MOVE_MADE);
 }
 
 void Board::unmakeMove() // unmakes the top move in moveHistory.
@@ -446,7 +418,8 @@ void Board::unmakeMove() // unmakes the top move in moveHistory.
   _sideToMove    ^= RED;
   _primaryHash   ^= COLOR_SWITCH_KEY;
   _secondaryHash ^= COLOR_SWITCH_KEY;
-  notifyObservers(MOVE_UNDONE);
+  positionHistory.pop_back();
+  if (!_searching) notifyObservers(MOVE_UNDONE);
 }
 
 void Board::notifyObservers(int message)
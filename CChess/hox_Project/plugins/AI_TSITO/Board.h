@@ -9,6 +9,7 @@
 #include	<vector>
 #include	<string>
 #include	<iostream>
+#include	<utility>
 
 #include	"Move.h"
 
@@ -25,9 +26,30 @@ typedef enum { EMPTY, ZU, PAO, CHE, MA, XIANG, SHI, LAO } piece;
 #define COLOR_SWITCH_KEY 0x80000000
 
 typedef unsigned long u_int32;
+typedef std::pair< u_int32, u_int32 > positionHash;
+
+// The most pieces of one kind and color a position may hold.
+#define MAX_PIECES	16
 
 class Board;
 
+// A read-only view of the squares of one kind of piece, as kept by the board.
+// It does not copy them, so it is only good until the next move.
+class PieceSquares
+{
+  const int *_squares;
+  int        _count;
+
+ public:
+  PieceSquares(const int *squares, int count) : _squares(squares), _count(count) {}
+
+  int size() const { return _count; }
+  bool empty() const { return _count == 0; }
+  int operator[](int i) const { return _squares[i]; }
+  const int *begin() const { return _squares; }
+  const int *end() const { return _squares + _count; }
+};
+
 class BoardObserver
 {
  public:
@@ -47,11 +69,19 @@ class Board
 
   bool			_gameOver;
   std::vector<Move>	moveHistory;
+  // Zobrist keys of the position after each move of moveHistory, for repetition
+  // checks.  Kept by the board itself so that it is right in search mode too.
+  std::vector<positionHash>	positionHistory;
+  // In search mode the moves made are not game moves: observers are not told.
+  bool			_searching;
   std::string		_startPos;
 
   int	kings[2];
-  std::vector< std::vector<int> >	rpieces;
-  std::vector< std::vector<int> >   	bpieces;
+  // Piece index: the squares of each kind of piece, by side (BLUE, RED) and piece
+  // type, and for each occupied square its place in that list.
+  int		pieceSquares[2][8][MAX_PIECES];
+  int		pieceCounts[2][8];
+  int		pieceIndex[BOARD_AREA];
 
   // Note: since the random values are generated by the
   // constructor, these may not be the same across boards;
@@ -99,6 +129,10 @@ class Board
 
   // Game move history access...
   std::vector<Move>& history() { return moveHistory; }
+  const std::vector<positionHash>& positions() const { return positionHistory; }
+  // Search mode: moves are made and unmade without notifying the observers.
+  void searching(bool s) { _searching = s; }
+  bool searching() const { return _searching; }
   // Game starting position...
   std::string& startingPosition() { return _startPos; }
 
@@ -107,7 +141,11 @@ class Board
 
   // Piece index access...
   int king(color c) { return kings[c==RED?1:0]; }
-  std::vector<int> pieces(color c, piece p);
+  PieceSquares pieces(color c, piece p) const
+    {
+      const int side = (c == RED ? 1:0);
+      return PieceSquares(pieceSquares[side][p], pieceCounts[side][p]);
+    }
 
   // Zoberist keys...
   u_int32 primaryHash() { return _primaryHash; }
@@ -251,13 +251,13 @@ long Evaluator::evaluatePosition(Board &theBoard, Lawyer &lawyer)
   for (int i = 1; i < 8; ++i) // Iterate through piece types...
     {
       // Gather each side's pieces.
-      vector<int> friendly   = theBoard.pieces(frend, (piece)i);
-      vector<int> unfriendly = theBoard.pieces(enemy, (piece)i);
+      PieceSquares friendly   = theBoard.pieces(frend, (piece)i);
+      PieceSquares unfriendly = theBoard.pieces(enemy, (piece)i);
 
       // Add piece values to score based on position on board.
-      for (vector<int>::iterator it = friendly.begin(); it != friendly.end(); it++)
+      for (const int *it = friendly.begin(); it != friendly.end(); it++)
         total += pieceValuesByLoc[i][0][*it]; // add values of friendly pieces
-      for (vector<int>::iterator it = unfriendly.begin(); it != unfriendly.end(); it++)
+      for (const int *it = unfriendly.begin(); it != unfriendly.end(); it++)
         total -= pieceValuesByLoc[i][1][*it]; // subtract values of enemy pieces.
     }
 
@@ -276,8 +276,8 @@ long Evaluator::evaluateMaterial(Board &theBoard)
   for (int i = 1; i < 8; i++) // Iterate through piece types...
     {
       // Gather each side's pieces.
-      vector<int> friendly   = theBoard.pieces(frend, (piece)i);
-      vector<int> unfriendly = theBoard.pieces(enemy, (piece)i);
+      PieceSquares friendly   = theBoard.pieces(frend, (piece)i);
+      PieceSquares unfriendly = theBoard.pieces(enemy, (piece)i);
 
       total += friendly.size() * pieceValues[i];
       total -= unfriendly.size() * pieceValues[i];
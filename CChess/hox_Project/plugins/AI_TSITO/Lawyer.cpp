@@ -1,4 +1,4 @@
-#include	<list>
+#include	<cstdlib>
 #include	"Lawyer.h"
 
 #include	"Move.h"
@@ -125,15 +125,15 @@ bool Lawyer::legalMove(Move &theMove) // This method checks to make sure the use
 
   // Very expensive, but very easy...basically generate all possible moves and see if the one we got
   // is in the list.
-  list<Move>	moveList;
+  MoveBuffer	moveList;
   bool		found = false;
   generateMoves(moveList);
   //cerr << "Number of moves: " << moveList.size() << endl;
-  for (list<Move>::iterator it = moveList.begin(); it != moveList.end(); it++)
+  for (int i = 0; i < moveList.size(); i++)
     {
-      if ((*it).origin() == theMove.origin() && (*it).destination() == theMove.destination())
+      if (moveList[i].origin() == theMove.origin() && moveList[i].destination() == theMove.destination())
         found = true;
-      //cerr << (*it) << endl;
+      //cerr << moveList[i] << endl;
     }
   if (!found) return false;
 
@@ -264,8 +264,9 @@ bool Lawyer::underAttack(int loc, int c)
   return false; // If we haven't returned true it means we haven't found an attacker.
 }
 
-void Lawyer::generateMoves(list<Move> &moveList, int loc, bool onlyLegal)
+void Lawyer::generateMoves(MoveBuffer &moveList, int loc, bool onlyLegal)
 {
+  if (onlyLegal) findPins();
   switch (board->pieceAt(loc))
     {
     case ZU:
@@ -293,13 +294,16 @@ void Lawyer::generateMoves(list<Move> &moveList, int loc, bool onlyLegal)
     }
 }
       
-void Lawyer::generateMoves(list<Move> &moveList, bool onlyLegal)
+void Lawyer::generateMoves(MoveBuffer &moveList, bool onlyLegal)
 {
+  if (onlyLegal) findPins();
   for (int i = 1; i < 8; i++) // iterate through piece types
     {
       // Get this colors piece locations for the piece in question
-      vector<int> locations = board->pieces(board->sideToMove(), (piece)i);
-      for (vector<int>::iterator it = locations.begin(); // iterate through the locations and generate moves for that piece.
+      // Trying a move (onlyLegal) puts this color's pieces back in the same order, so
+      // the view stays good while we generate.
+      PieceSquares locations = board->pieces(board->sideToMove(), (piece)i);
+      for (const int *it = locations.begin(); // iterate through the locations and generate moves for that piece.
            it != locations.end();
            it++)
         {
@@ -331,9 +335,73 @@ void Lawyer::generateMoves(list<Move> &moveList, bool onlyLegal)
     }
 }
 
-void Lawyer::addMove(list<Move> &moveList, Move &theMove, bool onlylegal) // Add a move to the move list.
+// Looks along the lines out from the king of the side to move and notes what each
+// piece there keeps from attacking it.  The only other attacks a move can uncover
+// are knights, through the legs next to the king.
+void Lawyer::findPins()
 {
-  if (!onlylegal) // If we are generating pseudo-legal moves then just add the move - don't check a damn thing.
+  color opponent = (board->sideToMove() == RED ? BLUE:RED);
+  _king = board->king(board->sideToMove());
+  _inCheck = inCheck();
+
+  for (int i = 0; i < 4; i++)
+    {
+      int found[3] = { -1, -1, -1 }; // the first three pieces on the line
+      int count = 0;
+      for (int x = boundingBoxKey[_king] + pieceMoves[CHE][i];
+           boundingBox[x] > -1 && count < 3; x += pieceMoves[CHE][i])
+        {
+          if (board->pieceAt(boundingBox[x]) != EMPTY) found[count++] = boundingBox[x];
+        }
+
+      bool cannonThird = (found[2] > -1 && board->pieceAt(found[2]) == PAO &&
+                          board->colorAt(found[2]) == opponent);
+      _lineFirst[i]    = found[0];
+      _lineSecond[i]   = found[1];
+      _firstPinned[i]  = cannonThird ||
+                         (found[1] > -1 && board->colorAt(found[1]) == opponent &&
+                          (board->pieceAt(found[1]) == CHE || board->pieceAt(found[1]) == JIANG));
+      _secondPinned[i] = cannonThird;
+      _cannonFirst[i]  = (found[0] > -1 && board->pieceAt(found[0]) == PAO &&
+                          board->colorAt(found[0]) == opponent);
+    }
+}
+
+// Which of the king's lines (see findPins) the location is on, or -1.
+int Lawyer::lineOf(int loc)
+{
+  if (loc / 9 == _king / 9) return (loc < _king ? 0:1);
+  if (loc % 9 == _king % 9) return (loc < _king ? 2:3);
+  return -1;
+}
+
+// False if the move surely leaves the king safe - true if it must be tried.
+bool Lawyer::mayExpose(int from, int to)
+{
+  if (_inCheck || from == _king) return true;
+
+  int diagonal = from - _king; // Knight legs.
+  if (diagonal == -10 || diagonal == -8 || diagonal == 8 || diagonal == 10) return true;
+
+  int fromLine = lineOf(from);
+  int toLine   = lineOf(to);
+  if (fromLine > -1)
+    {
+      if (fromLine == toLine) return true; // Moving along a line - too many cases.
+      if (from == _lineFirst[fromLine] && _firstPinned[fromLine]) return true;
+      if (from == _lineSecond[fromLine] && _secondPinned[fromLine]) return true;
+    }
+  if (toLine > -1 && _cannonFirst[toLine] &&
+      abs(to - _king) < abs(_lineFirst[toLine] - _king))
+    return true;
+  return false;
+}
+
+void Lawyer::addMove(MoveBuffer &moveList, Move &theMove, bool onlylegal) // Add a move to the move list.
+{
+  // If we are generating pseudo-legal moves, or the move cannot uncover or give
+  // check to our own king, then just add the move - don't check a damn thing.
+  if (!onlylegal || !mayExpose(theMove.origin(), theMove.destination()))
     {
       moveList.push_back(theMove);
       return;
@@ -356,7 +424,7 @@ void Lawyer::addMove(list<Move> &moveList, Move &theMove, bool onlylegal) // Add
  * methods then the breakpoint can be set for the method for that piece.  Also, this may
  * improve performance as some of the hackery involved in merging these methods may not
  * be particularly good. */
-void Lawyer::generatePawnMoves(int from, list<Move> &moveList, bool onlyLegal)
+void Lawyer::generatePawnMoves(int from, MoveBuffer &moveList, bool onlyLegal)
 {
   static int offsets[] = { -1, 13, 1 };
   int colorModifier = board->colorAt(from) == RED ? -1:1; // Invert offsets if we are red.
@@ -364,7 +432,7 @@ void Lawyer::generatePawnMoves(int from, list<Move> &moveList, bool onlyLegal)
     {
       int dest = boundingBox[boundingBoxKey[from] + (offsets[i] * colorModifier)]; // generate a location
       int legalIndex = colorModifier == -1 ? (89-dest):dest; // make sure it is legal to have a pawn here.
-      if (dest > 0 && (legalPositions[legalIndex] & pieceMasks[ZU]))
+      if (dest > -1 && (legalPositions[legalIndex] & pieceMasks[ZU]))
         {
           if (board->pieceAt(dest) == EMPTY || board->colorAt(dest) != board->colorAt(from))
             {
@@ -375,7 +443,7 @@ void Lawyer::generatePawnMoves(int from, list<Move> &moveList, bool onlyLegal)
         }
     }
 }
-void Lawyer::generateCanonMoves(int from, list<Move> &moveList, bool onlyLegal)
+void Lawyer::generateCanonMoves(int from, MoveBuffer &moveList, bool onlyLegal)
 {
   static int offsets[] = { -1, -13, 13, 1 };
   for (int i = 0; i < 4; i++) // hop through offsets
@@ -407,7 +475,7 @@ void Lawyer::generateCanonMoves(int from, list<Move> &moveList, bool onlyLegal)
         }
     }
 }
-void Lawyer::generateRookMoves(int from, list<Move> &moveList, bool onlyLegal)
+void Lawyer::generateRookMoves(int from, MoveBuffer &moveList, bool onlyLegal)
 {
   static int offsets[] = { -1, -13, 13, 1 };
   for (int i = 0; i < 4; i++) // hop through offsets
@@ -434,7 +502,7 @@ void Lawyer::generateRookMoves(int from, list<Move> &moveList, bool onlyLegal)
         }
     }
 }
-void Lawyer::generateKnightMoves(int from, list<Move> &moveList, bool onlyLegal)
+void Lawyer::generateKnightMoves(int from, MoveBuffer &moveList, bool onlyLegal)
 {
   static int offsets[] = {-11, -15, -25, -27, 11, 15, 25, 27 }; // moves
   static int blocks[]  = {  1,  -1,  -9,  -9, -1,  1,  9,  9 }; // if these are occupied we can't make the move to
@@ -442,7 +510,7 @@ void Lawyer::generateKnightMoves(int from, list<Move> &moveList, bool onlyLegal)
   for (int i = 0; i < 8; i++)
     {
       int dest = boundingBox[boundingBoxKey[from] + offsets[i]];
-      if (dest > 0 && board->pieceAt(from + blocks[i]) == EMPTY) // if on the board and the block square is empty
+      if (dest > -1 && board->pieceAt(from + blocks[i]) == EMPTY) // if on the board and the block square is empty
         {
           if (board->pieceAt(dest) == EMPTY || board->colorAt(dest) != board->colorAt(from)) // unoccupied or enemy.
             {
@@ -452,7 +520,7 @@ void Lawyer::generateKnightMoves(int from, list<Move> &moveList, bool onlyLegal)
         }
     }
 }
-void Lawyer::generateElephantMoves(int from, list<Move> &moveList, bool onlyLegal)
+void Lawyer::generateElephantMoves(int from, MoveBuffer &moveList, bool onlyLegal)
 {
   static int offsets[] = { -28, -24, 24, 28 }; // moves
   static int blocks[]  = { -10,  -8,  8, 10 }; // same as per knight.
@@ -460,7 +528,7 @@ void Lawyer::generateElephantMoves(int from, list<Move> &moveList, bool onlyLega
     {
       int dest = boundingBox[boundingBoxKey[from] + offsets[i]];
       int legalIndex = board->colorAt(from) == RED ? (89-dest):dest;
-      if (dest > 0 &&
+      if (dest > -1 &&
           board->pieceAt(from + blocks[i]) == EMPTY &&
           (legalPositions[legalIndex] & pieceMasks[XIANG])) // On board, legal location, not blocked.
         {
@@ -472,14 +540,14 @@ void Lawyer::generateElephantMoves(int from, list<Move> &moveList, bool onlyLega
         }
     }
 }
-void Lawyer::generateGuardMoves(int from, list<Move> &moveList, bool onlyLegal)
+void Lawyer::generateGuardMoves(int from, MoveBuffer &moveList, bool onlyLegal)
 {
   static int offsets[] = { -14, -12, 12, 14 }; // moves
   for (int i = 0; i < 4; i++)
     {
       int dest = boundingBox[boundingBoxKey[from] + offsets[i]];
       int legalIndex = board->colorAt(from) == RED ? (89-dest):dest;
-      if (dest > 0 && (legalPositions[legalIndex] & pieceMasks[SHI])) // on board and legal location
+      if (dest > -1 && (legalPositions[legalIndex] & pieceMasks[SHI])) // on board and legal location
         {
           if (board->pieceAt(dest) == EMPTY || board->colorAt(from) != board->colorAt(dest)) // unoccupied or enemy
             {
@@ -489,7 +557,7 @@ void Lawyer::generateGuardMoves(int from, list<Move> &moveList, bool onlyLegal)
         }
     }
 }
-void Lawyer::generateGeneralMoves(int from, list<Move> &moveList, bool onlyLegal)
+void Lawyer::generateGeneralMoves(int from, MoveBuffer &moveList, bool onlyLegal)
 {
   static int offsets[] = { -1, -13, 1, 13 }; // offsets
   int kingLineOffset = board->colorAt(from) == RED ? -13:13; // offset for checking for king-face capture
@@ -497,7 +565,7 @@ void Lawyer::generateGeneralMoves(int from, list<Move> &moveList, bool onlyLegal
     {
       int dest = boundingBox[boundingBoxKey[from] + offsets[i]];
       int legalIndex = board->colorAt(from) == RED ? (89-dest):dest; 
-      if (dest > 0 && (legalPositions[legalIndex] & pieceMasks[JIANG])) // on board and legal location.
+      if (dest > -1 && (legalPositions[legalIndex] & pieceMasks[JIANG])) // on board and legal location.
         {
           if (board->pieceAt(dest) == EMPTY || board->colorAt(from) != board->colorAt(dest))
             {
@@ -528,6 +596,7 @@ void Lawyer::generateGeneralMoves(int from, list<Move> &moveList, bool onlyLegal
 int Lawyer::gameWonByChase()
 {
   vector< Move > moveHistory = board->history();
+  const vector< positionHash > &positionalHistory = board->positions();
   vector< Move > undoHistory;
   int size = positionalHistory.size();
   if (size < 5) return NOCOLOR;
@@ -546,7 +615,7 @@ int Lawyer::gameWonByChase()
       moveHistory[size-5].destination() == moveHistory[size-1].destination() &&
       moveHistory[size-2].origin() == moveHistory[size - 4].destination())
     {
-      list<Move> atks;
+      MoveBuffer atks;
       board->makeNullMove();
       generateMoves(atks, moveHistory[size-1].destination());
       board->unmakeNullMove();
@@ -558,8 +627,8 @@ int Lawyer::gameWonByChase()
       locA = moveHistory[size-2].destination();
       locB = moveHistory[size-2].origin();
       possible = false;
-      for (list<Move>::iterator it = atks.begin(); it != atks.end(); it++)
-        if (it->destination() == locA) { possible = true; break; }
+      for (int i = 0; i < atks.size(); i++)
+        if (atks[i].destination() == locA) { possible = true; break; }
       if (possible == true)
         {
           // Check if we are protected by any piece...
@@ -578,8 +647,8 @@ int Lawyer::gameWonByChase()
               generateMoves(atks, board->history()[size-3].destination());
               board->unmakeNullMove();
               possible = false;
-              for (list<Move>::iterator it = atks.begin(); it != atks.end(); it++)
-                if (it->destination() == locB) { possible = true; break; }
+              for (int i = 0; i < atks.size(); i++)
+                if (atks[i].destination() == locB) { possible = true; break; }
               if (possible == true)
                 {
                   if (underAttack(locB, board->colorAt(locB)))
@@ -636,19 +705,3 @@ int Lawyer::gameWonByPCheck()
     }
   return NOCOLOR;
 }
-
-void Lawyer::boardChanged(Board *brd, int message)
-{
-  switch(message)
-    {
-    case BOARD_ALTERED:
-      positionalHistory.clear();
-      break;
-    case MOVE_MADE:
-      positionalHistory.push_back(make_pair(brd->primaryHash(), brd->secondaryHash()));
-      break;
-    case MOVE_UNDONE:
-      positionalHistory.pop_back();
-      break;
-    }
-}
@@ -16,16 +16,11 @@
  *
  */
 
-#include	<list>
 #include	<string>
-#include	<utility>
 #include	"HashTable.h"
 
-class Move;
 #include	"Board.h"
-
-typedef unsigned long ulong;
-typedef std::pair< ulong, ulong > positionHash;
+#include	"MoveBuffer.h"
 
 class Lawyer : public BoardObserver
 {
@@ -44,10 +39,24 @@ class Lawyer : public BoardObserver
   Board	*board;
 
   std::string message;
-  std::vector< positionHash > positionalHistory;
-
 
-  void addMove(std::list<Move> &moveList, Move &theMove, bool onlylegal = false);
+  /* What the king of the side to move is exposed to, found once per position by
+   * findPins() for legal move generation.  The lines are the king's rank and file,
+   * one per direction of pieceMoves[CHE]; on each we keep the first and second
+   * piece out from the king. */
+  bool _inCheck;
+  int  _king;
+  int  _lineFirst[4];
+  int  _lineSecond[4];
+  bool _firstPinned[4];  // moving the first piece off the line uncovers an attack
+  bool _secondPinned[4]; // moving the second piece off the line uncovers a cannon
+  bool _cannonFirst[4];  // the first piece is an enemy cannon: anything put in
+                         // front of it screens it.
+
+  void findPins();
+  int  lineOf(int location);
+  bool mayExpose(int origin, int destination);
+  void addMove(MoveBuffer &moveList, Move &theMove, bool onlylegal = false);
  public:
   Lawyer(Board *brd);
   bool legalMove(Move &theMove);
@@ -67,26 +76,25 @@ class Lawyer : public BoardObserver
    * it is simply cheaper to search the illegal trees.  Must make sure that the program never
    * rates loosing a king better than loosing a rook and then the king.
    */
-  void generateMoves(std::list<Move> &moves, bool onlyLegal = false);
-  void generateMoves(std::list<Move> &moves, int location, bool legalonly = true);
-  //void generateMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
+  void generateMoves(MoveBuffer &moves, bool onlyLegal = false);
+  void generateMoves(MoveBuffer &moves, int location, bool legalonly = true);
+  // (The per piece generators below rely on one of these to call findPins() first.)
+  //void generateMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
   void setBoard(Board *brd) { board = brd; }
 
   // generation functions - one for each piece.
-  void generatePawnMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
-  void generateCanonMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
-  void generateRookMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
-  void generateKnightMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
-  void generateElephantMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
-  void generateGuardMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
-  void generateGeneralMoves(int location, std::list<Move> &moveList, bool onlyLegal = false);
+  void generatePawnMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
+  void generateCanonMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
+  void generateRookMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
+  void generateKnightMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
+  void generateElephantMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
+  void generateGuardMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
+  void generateGeneralMoves(int location, MoveBuffer &moveList, bool onlyLegal = false);
 
   // returns color that won.
   int gameWonByChase();
   int gameWonByPCheck();
   bool gameDrawn();
-
-  void boardChanged(Board* brd, int msg);
 };
 
 #endif /* __LAWYER_H__ */
@@ -0,0 +1,76 @@
+#ifndef __MOVE_BUFFER_H__
+#define __MOVE_BUFFER_H__
+
+/*
+ * MoveBuffer.h
+ * Class MoveBuffer: a list of moves with a fixed capacity, meant to live on the
+ * stack.  The search fills one at every node, so it must never touch the heap.
+ */
+
+#include <cassert>
+
+#include "Move.h"
+
+class MoveBuffer
+{
+public:
+    // More than the pseudo-legal moves of any XiangQi position.
+    enum { CAPACITY = 128 };
+
+private:
+    Move    _moves[CAPACITY];
+    int     _size;
+
+public:
+    MoveBuffer() : _size( 0 ) {}
+
+    int  size() const  { return _size; }
+    bool empty() const { return _size == 0; }
+    void clear()       { _size = 0; }
+
+    // Keeps only the first n moves.
+    void truncate(int n) { if ( n < _size ) _size = n; }
+
+    void push_back(const Move& m)
+    {
+        assert( _size < CAPACITY );
+        _moves[_size++] = m;
+    }
+
+    Move&       operator[](int i)       { return _moves[i]; }
+    const Move& operator[](int i) const { return _moves[i]; }
+
+    /**
+     * A stable sort (a merge sort through a scratch buffer), so the moves come
+     * out in the same order as std::list::sort would put them.
+     */
+    template<class Compare>
+    void sort(Compare comp)
+    {
+        Move  scratch[CAPACITY];
+        Move* from = _moves;
+        Move* to   = scratch;
+
+        for ( int width = 1; width < _size; width *= 2 )
+        {
+            for ( int lo = 0; lo < _size; lo += 2 * width )
+            {
+                const int mid = ( lo + width < _size ? lo + width : _size );
+                const int hi  = ( mid + width < _size ? mid + width : _size );
+                int i = lo, j = mid, k = lo;
+                while ( i < mid && j < hi )
+                    to[k++] = ( comp( from[j], from[i] ) ? from[j++] : from[i++] );
+                while ( i < mid ) to[k++] = from[i++];
+                while ( j < hi )  to[k++] = from[j++];
+            }
+            Move* t = from; from = to; to = t;
+        }
+
+        if ( from != _moves )
+        {
+            for ( int i = 0; i < _size; ++i ) _moves[i] = from[i];
+        }
+    }
+};
+
+#endif /* __MOVE_BUFFER_H__ */
@@ -7,12 +7,10 @@ TNode::TNode(Board *board)
   this->_key  = board->primaryHash();
   this->_lock = board->secondaryHash();
 
-  //this->_posText = board->getPosition();
-
   _flag = NOT_FOUND;
   _score = 0;
   _depth = -1;
-  _stale = true;
+  _age = 0;
 }
 
 void TNode::move(Move &m)
@@ -29,69 +27,44 @@ Move TNode::move()
 // The Table...
 TranspositionTable::TranspositionTable(int bits)
 {
-  redTable  = new HashTable<TNode>(bits);
-  blueTable = new HashTable<TNode>(bits);
-
-  size = 1<<bits;
+  table = new HashTable<TNode>(bits);
+  generation = 1; // Never the age of an empty node.
 }
 
 TranspositionTable::~TranspositionTable()
 {
-  delete redTable;
-  delete blueTable;
+  delete table;
 }
 
-void TranspositionTable::store(TNode &node)
+/* The side to move is the COLOR_SWITCH_KEY bit of the primary key, which the index
+   mask drops; fold it into the low bits so that a position and its null-move twin
+   do not fight over one slot. */
+unsigned int TranspositionTable::slot(unsigned int key)
 {
-  if (node.key() & COLOR_SWITCH_KEY)
-    _store(node, redTable);
-  else
-    _store(node, blueTable);
+  return (key & COLOR_SWITCH_KEY) ? (key ^ 0x2545F491) : key;
 }
 
 /* Implementing a DEPTH Transposition table - positions are stored if they where
-   searched more turoughly than what is aleady there. */
-void TranspositionTable::_store(TNode &node, HashTable<TNode> *in)
+   searched more turoughly than what is aleady there, or if what is there is left
+   over from an earlier search. */
+void TranspositionTable::store(TNode &node)
 {
-  TNode there = in->find(node.key());
-  if ((there.stale() || there.depth() <= node.depth()))
+  TNode &there = table->find(slot(node.key()));
+  if (there.age() != generation || there.depth() <= node.depth())
     {
-      in->insert(node.key(), node);
+      node.age(generation);
+      table->insert(slot(node.key()), node);
     }
 }
 
 void TranspositionTable::find(Board *board, TNode &node)
 {
-  if (board->sideToMove() == RED)
-    _find(board, node, redTable);
-  else
-    _find(board, node, blueTable);
-}
-
-void TranspositionTable::_find(Board *board, TNode &node, HashTable<TNode> *in)
-{
-  node = in->find(board->primaryHash());
-  if (node.key() != board->primaryHash() || node.lock() != board->secondaryHash())
-    node = TNode();
-  else if (node.stale())
-    {
-      node.stale(false);
-      //node.depth(0); // Because perpetual moves are not detected if save values!
-      in->insert(node.key(), node);
-    }
-}
-
-
-void TranspositionTable::flush()
-{
-  TNode x;
-  for (int i = 0; i < size; i++)
+  TNode &there = table->find(slot(board->primaryHash()));
+  if (there.key() != board->primaryHash() || there.lock() != board->secondaryHash())
     {
-      x = blueTable->find(i);
-      x.stale(true);
-      blueTable->insert(i,x);
-      x = redTable->find(i);
-      x.stale(true);
-      redTable->insert(i,x);
+      node = TNode();
+      return;
     }
+  there.age(generation); // Still useful: keep it through this search.
+  node = there;
 }
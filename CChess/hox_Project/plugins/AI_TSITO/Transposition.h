@@ -11,45 +11,43 @@
 class Board;
 class Move;
 
-#include	<string>
-
 enum { NOT_FOUND = 0, EXACT_SCORE = 1, UPPER_BOUND = 2, LOWER_BOUND = 3 };
 
+/* 16 bytes: the two keys of HashNode, then the packed search result.  The age is
+ * the table generation in which the node was last stored or found; a node from an
+ * older search may be replaced by anything.
+ */
 class TNode : public HashNode
 {
   unsigned short	bestMove;
-  long			_score;
+  short			_score;
+  signed char		_depth;
   unsigned char		_flag;
-  int			_depth;
-  bool			_stale;
-  std::string		_posText;
+  unsigned char		_age;
 
  public:
-  TNode() { _flag = NOT_FOUND; _depth = -1; _score = 0; bestMove = 0;_stale=true;}
+  TNode() { _flag = NOT_FOUND; _depth = -1; _score = 0; bestMove = 0; _age = 0; }
   TNode(Board *brd);
   void move(Move &m);
-  void score(long s)         { _score = s; }
+  void score(long s)         { _score = (short)s; }
   void flag(unsigned char f)  { _flag = f; }
-  void depth(int d) { _depth = d; }
-  void stale(bool s) { _stale = s; }
+  void depth(int d) { _depth = (signed char)d; }
+  void age(unsigned char a) { _age = a; }
 
   Move move();
   long score()         { return _score; }
   unsigned char flag()  { return _flag; }
   int depth() { return _depth; }
-  bool stale() { return _stale; }
-  std::string pos() { return _posText; }
+  unsigned char age() { return _age; }
 };
 
+/* One table for both sides: the side to move is part of the primary key. */
 class TranspositionTable
 {
-  HashTable<TNode>*  redTable;
-  HashTable<TNode>*  blueTable;
-
-  int size;
+  HashTable<TNode>*  table;
+  unsigned char      generation;
 
-  void _find(Board *board, TNode &node, HashTable<TNode> *in);
-  void _store(TNode &node, HashTable<TNode> *in);
+  unsigned int slot(unsigned int key);
 
  public:
   TranspositionTable(int bits);
@@ -58,7 +56,9 @@ class TranspositionTable
   void store(TNode &node);
   void find(Board *board, TNode &node);
 
-  void flush();
+  // Ages every node at once, in place of clearing the table between searches.
+  // Generation 0 is the age of empty nodes, so the counter skips it as it wraps.
+  void newSearch() { if (++generation == 0) generation = 1; }
 };
 
 #endif /* __TRANSPOSITION_H__ */
@@ -25,7 +25,7 @@ tsiEngine::tsiEngine( Board *brd, Lawyer *law )
 {
     evaluator         = Evaluator::defaultEvaluator();
     _openingBook      = NULL;
-    _transposTable    = new TranspositionTable(18);
+    _transposTable    = new TranspositionTable(19);
 
     // Options and their defaults...
     _maxPly           = /* HPHAN: 6 */ 2;
@@ -207,7 +207,7 @@ tsiEngine::think()
         _searchState = SEARCHING;
         _principleVariation.clear();
         //_myTimer->startTimer();
-        _transposTable->flush();
+        _transposTable->newSearch();
         killer1.clear();
         killer2.clear();
         ftime(&_startTime);
@@ -237,6 +237,7 @@ tsiEngine::think()
     long result = evaluator->evaluatePosition(*board, *lawyer);
 
     _searchAborted = NO_ABORT;
+    board->searching(true); // Nobody needs to hear about the moves we try.
   
     for ( int i = ( _useIterDeep ? (_principleVariation.size()+1)
                                  : _maxPly );
@@ -262,6 +263,8 @@ tsiEngine::think()
         }
     }
 
+    board->searching(false);
+
     // We may continue searching if there is data to be read...depends on what we read.
     if (_searchAborted != ABORT_READ) // a) finished, b) timed out - either way we are done.
     {   // Search is completed then.
@@ -272,6 +275,18 @@ tsiEngine::think()
   return result;
 }
 
+void
+tsiEngine::setHashSize(int megabytes)
+{
+    // 16 bytes a node: 2^16 nodes to the megabyte.
+    int bits = 16;
+    while ( bits < 28 && (1 << (bits - 15)) <= megabytes )
+        ++bits;
+
+    delete _transposTable;
+    _transposTable = new TranspositionTable(bits);
+}
+
 Move
 tsiEngine::getMove()
 {
@@ -367,26 +382,16 @@ tsiEngine::optionChanged(const std::string& whatOption)
 }
 
 
-void tsiEngine::filterOutNonCaptures(list<Move> &moveList)
+void tsiEngine::filterOutNonCaptures(MoveBuffer &moveList)
 {
   if (lawyer->inCheck()) return; // In check positions we want to look at all legal moves.
 
-  list<Move> copy;
-
   // Otherwise only captures.
-  for (list<Move>::iterator it = moveList.begin(); it != moveList.end();)
-    {
-      if (board->pieceAt(it->destination()) == EMPTY)
-        {
-          break; // captures are on top (assuming sorted) so we can just stop processing here.
-        }
-      else
-        {
-          copy.push_back(*it);
-          it++;
-        }
-    }
-    moveList = copy; // This will be faster because there will be fewer moves...usually
+  int captures = 0;
+  while (captures < moveList.size() &&
+         board->pieceAt(moveList[captures].destination()) != EMPTY)
+    captures++; // captures are on top (assuming sorted) so we can just stop at the first quiet move.
+  moveList.truncate(captures);
 }
 
 std::string
@@ -431,7 +436,7 @@ long tsiEngine::search(vector<PVEntry> &pv, long alpha, long beta, int ply, int
   vector<PVEntry> myPV;
   long value = 0;
   bool failHigh = false;
-  list<Move>		moveList;
+  MoveBuffer		moveList;
 
   if (_searchAborted) return 0;
 
@@ -570,7 +575,7 @@ long tsiEngine::quiescence(long alpha, long beta, int ply, int depth, bool nullO
     */
 {
   long value = 0;
-  list<Move>	moveList;
+  MoveBuffer	moveList;
   bool		legalonly = false;
   vector<PVEntry> myPV;
   bool verify = false;
@@ -647,7 +652,7 @@ long tsiEngine::quiescence(long alpha, long beta, int ply, int depth, bool nullO
 }
 
 // Traditional AlphaBeta Search...
-long tsiEngine::alphaBeta(vector<PVEntry> &pv, list<Move> moveList, long alpha, long beta,
+long tsiEngine::alphaBeta(vector<PVEntry> &pv, const MoveBuffer &moveList, long alpha, long beta,
                        int ply, int depth, bool legalonly, bool nullOk,
                        bool verify)
   /* Inputs : moveList (list of moves to search), alpha (lower bound), beta (upper),
@@ -664,16 +669,17 @@ long tsiEngine::alphaBeta(vector<PVEntry> &pv, list<Move> moveList, long alpha,
   long value     = 0;
 
   // Iterate through the moves to find the best one.
-  for (list<Move>::iterator it = moveList.begin();
-       it != moveList.end() && best < beta; // have moves and haven't surpassed beta
-       it++)
+  for (int i = 0;
+       i < moveList.size() && best < beta; // have moves and haven't surpassed beta
+       i++)
     // We stop searching at beta because that means this line is worse for the other side
     // than any that came before, so they won't make that move and so this line never
     // takes place.  We assume the other player makes the best move possible.
     {
+      Move theMove = moveList[i]; // makeMove() records the capture in it.
       vector<PVEntry> tempPV;
-      tempPV.push_back(PVEntry(*it,NO_CUTOFF));
-      board->makeMove(*it);
+      tempPV.push_back(PVEntry(theMove,NO_CUTOFF));
+      board->makeMove(theMove);
       if (best > alpha)  alpha = best; // We don't care about any lines that score less than
                                        // our current best.
       value = -search(tempPV, -beta, -alpha, ply+1, depth, false, true, verify);
@@ -699,7 +705,7 @@ long tsiEngine::alphaBeta(vector<PVEntry> &pv, list<Move> moveList, long alpha,
 // window and then the rest with 0 width windows just to prove the first was the best.
 // If the first is not the best then we research the one that gave us a better score
 // with window between beta and the returned score to find a true value.
-long tsiEngine::negaScout(std::vector<PVEntry> &pv,  std::list<Move> moveList,
+long tsiEngine::negaScout(std::vector<PVEntry> &pv, const MoveBuffer &moveList,
                        long alpha, long beta, int ply, int depth,
                        bool legalonly, bool nullOk, bool verify)
   /* Inputs : moveList (list of moves to search), alpha (lower bound), beta (upper),
@@ -720,17 +726,18 @@ long tsiEngine::negaScout(std::vector<PVEntry> &pv,  std::list<Move> moveList,
   long t = 0;
 
 
-  for (list<Move>::iterator it = moveList.begin(); it != moveList.end() && a < beta; it++)
+  for (int i = 0; i < moveList.size() && a < beta; i++)
     {
+      Move theMove = moveList[i]; // makeMove() records the capture in it.
       vector<PVEntry> tempPV;
-      tempPV.push_back(PVEntry(*it, NO_CUTOFF));
-      board->makeMove(*it);
+      tempPV.push_back(PVEntry(theMove, NO_CUTOFF));
+      board->makeMove(theMove);
       t = -search(tempPV, -b, -a, ply+1, depth, false, true, verify);
-      if (t > a && t < beta && it != moveList.begin() && ply < depth-1)
+      if (t > a && t < beta && i > 0 && ply < depth-1)
         // Best move was not best - must search again.
         {
           tempPV.clear();
-          tempPV.push_back(PVEntry(*it, NO_CUTOFF));
+          tempPV.push_back(PVEntry(theMove, NO_CUTOFF));
           a = -search(tempPV, -beta, -t, ply+1, depth, false, true, verify);
         }
       board->unmakeMove();
@@ -815,6 +822,28 @@ void tsiEngine::tableSet(int ply, int depth, long alpha, long beta, Move m, long
   _transposTable->store(storeNode);
 }
 
+unsigned long long tsiEngine::perft(int depth)
+{
+  if (depth <= 0) return 1;
+
+  MoveBuffer moveList;
+  lawyer->generateMoves(moveList, true);
+
+  const bool wasSearching = board->searching();
+  board->searching(true);
+
+  unsigned long long leaves = 0;
+  for (int i = 0; i < moveList.size(); i++)
+    {
+      board->makeMove(moveList[i]);
+      leaves += perft(depth - 1);
+      board->unmakeMove();
+    }
+
+  board->searching(wasSearching);
+  return leaves;
+}
+
 void tsiEngine::endSearch()    { _searchState = DONE_SEARCHING; }
 bool tsiEngine::doneThinking() { return _searchState == DONE_SEARCHING; }
 bool tsiEngine::thinking()     { return _searchState == SEARCHING; }
@@ -14,6 +14,7 @@
 #include <sys/timeb.h>
 
 #include "Move.h"
+#include "MoveBuffer.h"
 #include "Options.h"
 #include "Timer.h"
 
@@ -103,16 +104,16 @@ private:
 
     // Search functions
     long quiescence(long alpha, long beta, int ply, int depth, bool nullOk = true);
-    void filterOutNonCaptures(std::list<Move> &l);
+    void filterOutNonCaptures(MoveBuffer &moveList);
 
     // Search algorithms...
 
-    long alphaBeta(std::vector<PVEntry> &pv, std::list<Move> moveList,
+    long alphaBeta(std::vector<PVEntry> &pv, const MoveBuffer &moveList,
                  long alpha, long beta, int ply, int depth,
                  bool legalonly = false, bool nullOk = true, bool verify = true);
     //long pvSearch(std::vector<PVEntry> &pv, long alpha, long beta, int ply, int depth,
     //              bool legalonly = false, bool nullOk = true, bool verify = true);
-    long negaScout(std::vector<PVEntry> &pv,  std::list<Move> moveList,
+    long negaScout(std::vector<PVEntry> &pv, const MoveBuffer &moveList,
                  long alpha, long beta, int ply, int depth,
                  bool legalonly = false, bool nullOk = true, bool verify = true);
 
@@ -141,6 +142,9 @@ public:
     // If board is replaced...
     void setBoard(Board *brd) { board = brd; }
 
+    // Replaces the transposition table by an empty one of about 'megabytes' MB.
+    void setHashSize(int megabytes);
+
     // Tells engine to think...
     long think();
 
@@ -152,6 +156,11 @@ public:
     // Search information retrieval...
     Move getMove();
     std::string variationText(const std::vector<PVEntry>& pv) const;
+    int nodes() const { return nodeCount; }
+
+    // Counts the legal move sequences of depth plies from the current
+    // position (perft), to check and time the move generator.
+    unsigned long long perft(int depth);
 
     // OptionObserver requirements
     void optionChanged(const std::string& whatOption);
@@ -29,12 +29,16 @@
 
 #include <AIEngineLib.h>
 #include <DefaultDelete.h>
+#include <cstdlib>
 #include "XQWLight.h"
 
 class AIEngineImpl : public DefaultDelete<AIEngineLib>
 {
 public:
     AIEngineImpl( const char* engineName )
+            : m_gameTime( 0 )
+            , m_increment( 0 )
+            , m_movesToGo( 0 )
     {
         m_name = engineName ? engineName : "__UNKNOWN__";
     }
@@ -51,7 +55,7 @@ public:
     void initEngine( int nAILevel = 0 )
     {
         setDifficultyLevel( nAILevel  == 0 ? 5 : nAILevel );
-        XQWLight::set_search_time( 60 /* seconds */ );
+        m_engine.set_search_time( 60 /* seconds */ );
     }
 
   	int initGame( const std::string& fen,
@@ -59,7 +63,7 @@ public:
     {
         if ( fen.empty() )
         {
-            XQWLight::init_game();
+            m_engine.init_game();
         }
         else
         {
@@ -69,19 +73,19 @@ public:
             {
                 return hoxAI_RC_ERR;
             }
-            XQWLight::init_game( board, side );
+            m_engine.init_game( board, side );
         }
         return hoxAI_RC_OK;
     }
 
 	std::string generateMove()
     {
-        return XQWLight::generate_move();
+        return m_engine.generate_move();
     }
 
     void onHumanMove( const std::string& sMove )
     {
-        XQWLight::on_human_move( sMove );
+        m_engine.on_human_move( sMove );
     }
 
     int setDifficultyLevel( int nAILevel )
@@ -92,7 +96,7 @@ public:
         else if ( nAILevel < 1 )  searchDepth = 1;
         else                      searchDepth = nAILevel;
 
-        XQWLight::init_engine( searchDepth );
+        m_engine.init_engine( searchDepth );
         return hoxAI_RC_OK;
     }
 
@@ -102,13 +106,68 @@ public:
                "www.elephantbase.net";
     }
 
+    int setOption( const std::string& name,
+                   const std::string& value )
+    {
+        if ( name == "Threads" )
+        {
+            m_engine.set_threads( ::atoi( value.c_str() ) );
+            return hoxAI_RC_OK;
+        }
+        if ( name == "Hash" )  // In MB.
+        {
+            m_engine.set_hash_size( ::atoi( value.c_str() ) );
+            return hoxAI_RC_OK;
+        }
+        if ( name == "Ponder" )
+        {
+            m_engine.set_ponder( value == "true" || value == "1" );
+            return hoxAI_RC_OK;
+        }
+        if ( name == "MoveTime" )  // In ms.
+        {
+            m_engine.set_move_time( ::atoi( value.c_str() ) );
+            return hoxAI_RC_OK;
+        }
+        if (    name == "GameTime"   // In ms.
+             || name == "Increment"  // In ms.
+             || name == "MovesToGo" )
+        {
+            int& field = (   name == "GameTime"  ? m_gameTime
+                           : name == "Increment" ? m_increment
+                                                 : m_movesToGo );
+            field = ::atoi( value.c_str() );
+            m_engine.set_time_control( m_gameTime, m_increment, m_movesToGo );
+            return hoxAI_RC_OK;
+        }
+        return hoxAI_RC_NOT_SUPPORTED;
+    }
+
+    int perft( int                 depth,
+               unsigned long long& nodes )
+    {
+        nodes = m_engine.perft( depth );
+        return hoxAI_RC_OK;
+    }
+
+    int getNodeCount( unsigned long long& nodes )
+    {
+        nodes = m_engine.get_node_count();
+        return hoxAI_RC_OK;
+    }
+
 private:
     bool _convertFENtoBoard( const std::string& fen,
                              unsigned char      board[10][9],
                              char&              side ) const;
 
 private:
-    std::string m_name;
+    std::string       m_name;
+    XQWLight::Engine  m_engine;
+
+    int               m_gameTime;   // The game clock (ms), as set by options.
+    int               m_increment;
+    int               m_movesToGo;
 
 }; /* class AIEngineImpl */
 
@@ -0,0 +1,74 @@
+/***************************************************************************
+ *  Copyright 2007-2009 Huy Phan  <huyphan@playxiangqi.com>                *
+ *                      Bharatendra Boddu (bharathendra at yahoo dot com)  *
+ *                                                                         *
+ *  This file is part of HOXChess.                                         *
+ *                                                                         *
+ *  HOXChess is free software: you can redistribute it and/or modify       *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  HOXChess is distributed in the hope that it will be useful,            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with HOXChess.  If not, see <http://www.gnu.org/licenses/>.      *
+ ***************************************************************************/
+
+/////////////////////////////////////////////////////////////////////////////
+// Name:            SeeCheck.cpp
+// Created:         10/16/2026
+//
+// Description:     Checks XQWLight's static exchange evaluation ("See")
+//                  on a few exchanges of known value ("make check").
+//
+//   The engine's position code is internal to XQWLight.cpp, so that file
+//   is compiled into this program rather than linked from the plugin.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "XQWLight.cpp"
+
+// The square of a 90-square board name ("a0" to "i9", red at the bottom)
+static int SquareOf(const char *sz) {
+  return COORD_XY(FILE_LEFT + sz[0] - 'a', RANK_BOTTOM - (sz[1] - '0'));
+}
+
+int main(void) {
+  static const char *const cszPieceTypes = "KABNRCP"; // By "PIECE_..." value
+  static const struct {
+    const char *szPieces;       // Piece letter (red in upper case) and square
+    const char *szMove;         // Black to move
+    int vlSee;
+  } cSees[] = {
+    {"Ke0 Ad2 Pe3 kd9 re8", "e8e3", 15},    // An advisor only defends the fort
+    {"Ke0 Ad2 Ne1 kd9 re8", "e8e1", -110},  // ... but it does defend it
+    {"Kd2 Nc2 kf9 rc8",     "c8c2", 90},    // So does the king
+    {"Kd2 Ne2 kf9 re8",     "e8e2", -110},
+  };
+  PositionStruct pos;
+  const char *lpsz;
+  int i, sd, vl, nErrors;
+
+  nErrors = 0;
+  for (i = 0; i < (int) (sizeof(cSees) / sizeof(cSees[0])); i ++) {
+    pos.ClearBoard();
+    for (lpsz = cSees[i].szPieces; *lpsz != '\0'; lpsz += (lpsz[3] == ' ' ? 4 : 3)) {
+      sd = (lpsz[0] >= 'a' ? 1 : 0);
+      pos.AddPiece(SquareOf(lpsz + 1), SIDE_TAG(sd) +
+          (strchr(cszPieceTypes, lpsz[0] - (sd == 0 ? 0 : 'a' - 'A')) - cszPieceTypes));
+    }
+    pos.ChangeSide();
+    pos.SetIrrev();
+    vl = pos.See(MOVE(SquareOf(cSees[i].szMove), SquareOf(cSees[i].szMove + 2)));
+    if (vl != cSees[i].vlSee) {
+      fprintf(stderr, "SeeCheck: %s, %s: %d instead of %d\n",
+          cSees[i].szPieces, cSees[i].szMove, vl, cSees[i].vlSee);
+      nErrors ++;
+    }
+  }
+  printf("SeeCheck: %d of %d exchanges right\n", i - nErrors, i);
+  return nErrors == 0 ? 0 : 1;
+}
@@ -37,6 +37,21 @@
 #include <sstream>     // ostringstream
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>   // std::sort
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <new>         // std::nothrow
+#if !defined(_WIN32)
+#include <sys/mman.h>  // mmap, madvise
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using XQWLight::EngineStruct;
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -57,8 +72,6 @@ typedef unsigned int       DWORD;
 #endif
 
 // *** Additional variables ***
-static int          s_search_depth = 7; // Search Depth
-static int          s_search_time = 1;  // In seconds (search-time)
 static const char*  s_opening_book = "../plugins/BOOK.DAT";
 
 ///////          END of  HPHAN's changes                      /////////////
@@ -97,11 +110,15 @@ const int ADVANCED_VALUE = 3;  // 
 const int RANDOM_MASK = 7;     // Էֵ
 const int NULL_MARGIN = 400;   // ղü߽
 const int NULL_DEPTH = 2;      // ղüĲü
-const int HASH_SIZE = 1 << 20; // ûС
+const int HASH_MB_DEFAULT = 16;  // ûС (MB)
+const int HASH_MB_MAX = 65536;   // Upper limit of the hash table size (MB)
 const int HASH_ALPHA = 1;      // ALPHAڵû
 const int HASH_BETA = 2;       // BETAڵû
 const int HASH_PV = 3;         // PVڵû
-const int BOOK_SIZE = 16384;   // ֿС
+const int MAX_THREADS = 64;     // Upper limit of (lazy-SMP) search threads
+const int TIME_POLL_NODES = 1024; // How often (in nodes) the main search polls the clock
+const int TIME_MOVES_LEFT = 30;   // The number of moves the remaining game time is shared by
+const int TIME_MARGIN = 50;       // The part of the game clock (ms) never used
 
 // жǷе
 static const char ccInBoard[256] = {
@@ -500,6 +517,184 @@ inline int MIRROR_MOVE(int mv) {
   return MOVE(MIRROR_SQUARE(SRC(mv)), MIRROR_SQUARE(DST(mv)));
 }
 
+// The square of the 90-square board (0-89, rank by rank from the top) of a
+// square of the 16x16 board
+inline int SQUARE90(int sq) {
+  return (RANK_Y(sq) - RANK_TOP) * 9 + FILE_X(sq) - FILE_LEFT;
+}
+
+// The lowest set bit of a non-zero word
+inline int LSB64(uint64_t qw) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(qw);
+#else
+  static const BYTE cucDeBruijn[64] = {
+     0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+    62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+    63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+    46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+  };
+  return cucDeBruijn[((qw & (0 - qw)) * 0x03f79d71b4cb0a89ULL) >> 58];
+#endif
+}
+
+// The squares of the 90-square board (see "SQUARE90") as bits of two 64-bit
+// words: squares 0-63 in "qwLo", squares 64-89 in "qwHi".
+struct BitBoard {
+  uint64_t qwLo, qwHi;
+
+  BOOL IsEmpty(void) const {
+    return (qwLo | qwHi) == 0;
+  }
+  void Set(int sq90) {
+    if (sq90 < 64) {
+      qwLo |= (uint64_t) 1 << sq90;
+    } else {
+      qwHi |= (uint64_t) 1 << (sq90 - 64);
+    }
+  }
+  void Flip(int sq90) {
+    if (sq90 < 64) {
+      qwLo ^= (uint64_t) 1 << sq90;
+    } else {
+      qwHi ^= (uint64_t) 1 << (sq90 - 64);
+    }
+  }
+  int PopLsb(void) {           // Remove the lowest square and return it
+    int sq90;
+    if (qwLo != 0) {
+      sq90 = LSB64(qwLo);
+      qwLo &= qwLo - 1;
+    } else {
+      sq90 = 64 + LSB64(qwHi);
+      qwHi &= qwHi - 1;
+    }
+    return sq90;
+  }
+  BitBoard operator &(const BitBoard &bb) const {
+    BitBoard bbRet = {qwLo & bb.qwLo, qwHi & bb.qwHi};
+    return bbRet;
+  }
+  BitBoard operator |(const BitBoard &bb) const {
+    BitBoard bbRet = {qwLo | bb.qwLo, qwHi | bb.qwHi};
+    return bbRet;
+  }
+  BitBoard operator ~(void) const {
+    BitBoard bbRet = {~qwLo, ~qwHi};
+    return bbRet;
+  }
+};
+
+// The moves of a rook or cannon along one rank or file, for one occupancy of
+// that line. Each mask has one bit per square of the line.
+struct SlideMoveStruct {
+  WORD wNonCap;     // The empty squares it can slide to
+  WORD wRookCap;    // The first pieces on both sides (captured by a rook)
+  WORD wCannonCap;  // The second pieces on both sides (captured by a cannon)
+};
+
+// Move and attack tables, indexed by "SQUARE90"
+static struct PreGenStruct {
+  BYTE ucsqSquares[90];                 // "SQUARE90" back to the 16x16 board
+  BitBoard bbKingMoves[90];             // Within the fort
+  BitBoard bbAdvisorMoves[90];          // Within the fort
+  BitBoard bbBishopMoves[90][4];        // By direction, blocked by "ucsqBishopPins"
+  BYTE ucsqBishopPins[90][4];           // The bishop eyes (0 if there is no move)
+  BitBoard bbKnightMoves[90][4];        // By leg (the "ccKingDelta" next square)
+  BitBoard bbKnightChecks[90][4];       // Knights checking us, by leg ("ccAdvisorDelta")
+  BitBoard bbPawnMoves[2][90];          // By side
+  BitBoard bbPawnChecks[2][90];         // Pawns checking the king of a side
+  SlideMoveStruct smvRankMoves[9][512]; // By file, and the rank occupancy
+  SlideMoveStruct smvFileMoves[10][1024]; // By rank, and the file occupancy
+} PreGen;
+
+// Compute the rook and cannon moves on a line of "nLength" squares
+static void InitSlideMoves(SlideMoveStruct &smv, int nPos, int nLength, int nOccupied) {
+  int nDelta, i;
+  smv.wNonCap = smv.wRookCap = smv.wCannonCap = 0;
+  for (nDelta = -1; nDelta <= 1; nDelta += 2) {
+    i = nPos + nDelta;
+    while (i >= 0 && i < nLength && (nOccupied & (1 << i)) == 0) {
+      smv.wNonCap |= 1 << i;
+      i += nDelta;
+    }
+    if (i >= 0 && i < nLength) {
+      smv.wRookCap |= 1 << i;
+      i += nDelta;
+      while (i >= 0 && i < nLength && (nOccupied & (1 << i)) == 0) {
+        i += nDelta;
+      }
+      if (i >= 0 && i < nLength) {
+        smv.wCannonCap |= 1 << i;
+      }
+    }
+  }
+}
+
+// Generate the move and attack tables
+static void InitPreGen(void) {
+  int sq, sq90, sqDst, sd, i, j;
+  memset(&PreGen, 0, sizeof(PreGen));
+  for (sq = 0; sq < 256; sq ++) {
+    if (!IN_BOARD(sq)) {
+      continue;
+    }
+    sq90 = SQUARE90(sq);
+    PreGen.ucsqSquares[sq90] = sq;
+    for (i = 0; i < 4; i ++) {
+      sqDst = sq + ccKingDelta[i];
+      if (IN_FORT(sqDst)) {
+        PreGen.bbKingMoves[sq90].Set(SQUARE90(sqDst));
+      }
+      sqDst = sq + ccAdvisorDelta[i];
+      if (IN_FORT(sqDst)) {
+        PreGen.bbAdvisorMoves[sq90].Set(SQUARE90(sqDst));
+      }
+      sqDst = sq + ccAdvisorDelta[i] * 2;
+      if (IN_BOARD(sqDst) && SAME_HALF(sq, sqDst)) {
+        PreGen.bbBishopMoves[sq90][i].Set(SQUARE90(sqDst));
+        PreGen.ucsqBishopPins[sq90][i] = BISHOP_PIN(sq, sqDst);
+      }
+      for (j = 0; j < 2; j ++) {
+        sqDst = sq + ccKnightDelta[i][j];
+        if (IN_BOARD(sqDst)) {
+          PreGen.bbKnightMoves[sq90][i].Set(SQUARE90(sqDst));
+        }
+        sqDst = sq + ccKnightCheckDelta[i][j];
+        if (IN_BOARD(sqDst)) {
+          PreGen.bbKnightChecks[sq90][i].Set(SQUARE90(sqDst));
+        }
+      }
+    }
+    for (sd = 0; sd < 2; sd ++) {
+      sqDst = SQUARE_FORWARD(sq, sd);
+      if (IN_BOARD(sqDst)) {
+        PreGen.bbPawnMoves[sd][sq90].Set(SQUARE90(sqDst));
+        PreGen.bbPawnChecks[sd][sq90].Set(SQUARE90(sqDst));
+      }
+      for (i = -1; i <= 1; i += 2) {
+        sqDst = sq + i;
+        if (IN_BOARD(sqDst)) {
+          if (AWAY_HALF(sq, sd)) {
+            PreGen.bbPawnMoves[sd][sq90].Set(SQUARE90(sqDst));
+          }
+          PreGen.bbPawnChecks[sd][sq90].Set(SQUARE90(sqDst));
+        }
+      }
+    }
+  }
+  for (i = 0; i < 9; i ++) {
+    for (j = 0; j < 512; j ++) {
+      InitSlideMoves(PreGen.smvRankMoves[i][j], i, 9, j);
+    }
+  }
+  for (i = 0; i < 10; i ++) {
+    for (j = 0; j < 1024; j ++) {
+      InitSlideMoves(PreGen.smvFileMoves[i][j], i, 10, j);
+    }
+  }
+}
+
 // RC4
 struct RC4Struct {
   BYTE s[256];
@@ -586,6 +781,12 @@ static void InitZobrist(void) {
   }
 }
 
+// The Zobrist keys and the move tables never change, so generate them once
+// (when the library is loaded) and share them between all engine instances.
+static struct TablesInitStruct {
+  TablesInitStruct() { InitZobrist(); InitPreGen(); }
+} s_TablesInit;
+
 // ʷ߷Ϣ(ռ4ֽ)
 struct MoveStruct {
   WORD wmv;
@@ -604,6 +805,10 @@ struct MoveStruct {
 struct PositionStruct {
   int sdPlayer;                   // ֵ˭ߣ0=췽1=ڷ
   BYTE ucpcSquares[256];          // ϵ
+  BitBoard bbPieces[24];          // The squares of each piece type (by "ucpcSquares" value)
+  BitBoard bbSides[2];            // The squares of each side's pieces
+  WORD wBitRanks[16];             // The occupied files of each rank (bit 0 = "FILE_LEFT")
+  WORD wBitFiles[16];             // The occupied ranks of each file (bit 0 = "RANK_TOP")
   int vlWhite, vlBlack;           // 졢˫ֵ
   int nDistance, nMoveNum;        // ڵĲʷ߷
   MoveStruct mvsList[MAX_MOVES];  // ʷ߷Ϣб
@@ -612,6 +817,10 @@ struct PositionStruct {
   void ClearBoard(void) {         // 
     sdPlayer = vlWhite = vlBlack = nDistance = 0;
     memset(ucpcSquares, 0, 256);
+    memset(bbPieces, 0, sizeof(bbPieces));
+    memset(bbSides, 0, sizeof(bbSides));
+    memset(wBitRanks, 0, sizeof(wBitRanks));
+    memset(wBitFiles, 0, sizeof(wBitFiles));
     zobr.InitZero();
   }
   void SetIrrev(void) {           // (ʼ)ʷ߷Ϣ
@@ -623,8 +832,15 @@ struct PositionStruct {
     sdPlayer = 1 - sdPlayer;
     zobr.Xor(Zobrist.Player);
   }
+  void FlipBits(int sq, int pc) { // Put a piece on (or take it off) the bitboards
+    bbPieces[pc].Flip(SQUARE90(sq));
+    bbSides[pc >> 4].Flip(SQUARE90(sq));
+    wBitRanks[RANK_Y(sq)] ^= 1 << (FILE_X(sq) - FILE_LEFT);
+    wBitFiles[FILE_X(sq)] ^= 1 << (RANK_Y(sq) - RANK_TOP);
+  }
   void AddPiece(int sq, int pc) { // Ϸһö
     ucpcSquares[sq] = pc;
+    FlipBits(sq, pc);
     // 췽ӷ֣ڷ(ע"cucvlPiecePos"ȡֵҪߵ)
     if (pc < 16) {
       vlWhite += cucvlPiecePos[pc - 8][sq];
@@ -636,6 +852,7 @@ struct PositionStruct {
   }
   void DelPiece(int sq, int pc) { // һö
     ucpcSquares[sq] = 0;
+    FlipBits(sq, pc);
     // 췽֣ڷ(ע"cucvlPiecePos"ȡֵҪߵ)ӷ
     if (pc < 16) {
       vlWhite -= cucvlPiecePos[pc - 8][sq];
@@ -676,11 +893,13 @@ struct PositionStruct {
     nMoveNum --;
     ChangeSide();
   }
-  // ߷"bCapture"Ϊ"TRUE"ֻɳ߷
-  int GenerateMoves(int *mvs, BOOL bCapture = FALSE) const;
+  // ߷"nGenType"Ϊ"GEN_CAPTURE"ֻɳ߷ ("GEN_NON_CAPTURE": only the others)
+  int GenerateMoves(int *mvs, int nGenType = 0) const;
   BOOL LegalMove(int mv) const;               // ж߷Ƿ
   BOOL Checked(void) const;                   // жǷ񱻽
   BOOL IsMate(void);                          // жǷɱ
+  int LeastAttacker(int sqDst, int sd) const; // The least valuable attacker of a square
+  int See(int mv);                            // Static exchange evaluation of a capture
   int DrawValue(void) const {                 // ֵ
     return (nDistance & 1) == 0 ? -DRAW_VALUE : DRAW_VALUE;
   }
@@ -771,160 +990,113 @@ BOOL PositionStruct::MakeMove(int mv) {
 }
 
 // "GenerateMoves"
-const BOOL GEN_CAPTURE = TRUE;
-
-// ߷"bCapture"Ϊ"TRUE"ֻɳ߷
-int PositionStruct::GenerateMoves(int *mvs, BOOL bCapture) const {
-  int i, j, nGenMoves, nDelta, sqSrc, sqDst;
-  int pcSelfSide, pcOppSide, pcSrc, pcDst;
+const int GEN_CAPTURE = 1;
+const int GEN_NON_CAPTURE = 2;
+
+// ߷"nGenType"Ϊ"GEN_CAPTURE"ֻɳ߷ ("GEN_NON_CAPTURE": only the others)
+int PositionStruct::GenerateMoves(int *mvs, int nGenType) const {
+  int i, nGenMoves, sqSrc, sq90, x, y;
+  int pcSelfSide, pcOppSide, nRankMask, nFileMask;
+  BitBoard bbSrcs, bbDsts, bbTargets;
+  const SlideMoveStruct *lpsmvRank, *lpsmvFile;
   // ߷Ҫ¼裺
 
   nGenMoves = 0;
   pcSelfSide = SIDE_TAG(sdPlayer);
   pcOppSide = OPP_SIDE_TAG(sdPlayer);
-  for (sqSrc = 0; sqSrc < 256; sqSrc ++) {
+  if (nGenType == GEN_CAPTURE) {
+    bbTargets = bbSides[1 - sdPlayer];
+  } else if (nGenType == GEN_NON_CAPTURE) {
+    bbTargets = ~(bbSides[0] | bbSides[1]);
+  } else {
+    bbTargets = ~bbSides[sdPlayer];
+  }
+  bbSrcs = bbSides[sdPlayer];
+  while (!bbSrcs.IsEmpty()) {
 
     // 1. ҵһӣжϣ
-    pcSrc = ucpcSquares[sqSrc];
-    if ((pcSrc & pcSelfSide) == 0) {
-      continue;
-    }
+    sq90 = bbSrcs.PopLsb();
+    sqSrc = PreGen.ucsqSquares[sq90];
 
     // 2. ȷ߷
-    switch (pcSrc - pcSelfSide) {
+    switch (ucpcSquares[sqSrc] - pcSelfSide) {
     case PIECE_KING:
-      for (i = 0; i < 4; i ++) {
-        sqDst = sqSrc + ccKingDelta[i];
-        if (!IN_FORT(sqDst)) {
-          continue;
-        }
-        pcDst = ucpcSquares[sqDst];
-        if (bCapture ? (pcDst & pcOppSide) != 0 : (pcDst & pcSelfSide) == 0) {
-          mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-          nGenMoves ++;
-        }
-      }
+      bbDsts = PreGen.bbKingMoves[sq90] & bbTargets;
       break;
     case PIECE_ADVISOR:
-      for (i = 0; i < 4; i ++) {
-        sqDst = sqSrc + ccAdvisorDelta[i];
-        if (!IN_FORT(sqDst)) {
-          continue;
-        }
-        pcDst = ucpcSquares[sqDst];
-        if (bCapture ? (pcDst & pcOppSide) != 0 : (pcDst & pcSelfSide) == 0) {
-          mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-          nGenMoves ++;
-        }
-      }
+      bbDsts = PreGen.bbAdvisorMoves[sq90] & bbTargets;
       break;
     case PIECE_BISHOP:
+      bbDsts.qwLo = bbDsts.qwHi = 0;
       for (i = 0; i < 4; i ++) {
-        sqDst = sqSrc + ccAdvisorDelta[i];
-        if (!(IN_BOARD(sqDst) && HOME_HALF(sqDst, sdPlayer) && ucpcSquares[sqDst] == 0)) {
-          continue;
-        }
-        sqDst += ccAdvisorDelta[i];
-        pcDst = ucpcSquares[sqDst];
-        if (bCapture ? (pcDst & pcOppSide) != 0 : (pcDst & pcSelfSide) == 0) {
-          mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-          nGenMoves ++;
+        if (ucpcSquares[PreGen.ucsqBishopPins[sq90][i]] == 0) {
+          bbDsts = bbDsts | PreGen.bbBishopMoves[sq90][i];
         }
       }
+      bbDsts = bbDsts & bbTargets;
       break;
     case PIECE_KNIGHT:
+      bbDsts.qwLo = bbDsts.qwHi = 0;
       for (i = 0; i < 4; i ++) {
-        sqDst = sqSrc + ccKingDelta[i];
-        if (ucpcSquares[sqDst] != 0) {
-          continue;
-        }
-        for (j = 0; j < 2; j ++) {
-          sqDst = sqSrc + ccKnightDelta[i][j];
-          if (!IN_BOARD(sqDst)) {
-            continue;
-          }
-          pcDst = ucpcSquares[sqDst];
-          if (bCapture ? (pcDst & pcOppSide) != 0 : (pcDst & pcSelfSide) == 0) {
-            mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-            nGenMoves ++;
-          }
+        if (ucpcSquares[sqSrc + ccKingDelta[i]] == 0) {
+          bbDsts = bbDsts | PreGen.bbKnightMoves[sq90][i];
         }
       }
+      bbDsts = bbDsts & bbTargets;
       break;
-    case PIECE_ROOK:
-      for (i = 0; i < 4; i ++) {
-        nDelta = ccKingDelta[i];
-        sqDst = sqSrc + nDelta;
-        while (IN_BOARD(sqDst)) {
-          pcDst = ucpcSquares[sqDst];
-          if (pcDst == 0) {
-            if (!bCapture) {
-              mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-              nGenMoves ++;
-            }
-          } else {
-            if ((pcDst & pcOppSide) != 0) {
-              mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-              nGenMoves ++;
-            }
-            break;
-          }
-          sqDst += nDelta;
-        }
-      }
+    case PIECE_PAWN:
+      bbDsts = PreGen.bbPawnMoves[sdPlayer][sq90] & bbTargets;
       break;
-    case PIECE_CANNON:
-      for (i = 0; i < 4; i ++) {
-        nDelta = ccKingDelta[i];
-        sqDst = sqSrc + nDelta;
-        while (IN_BOARD(sqDst)) {
-          pcDst = ucpcSquares[sqDst];
-          if (pcDst == 0) {
-            if (!bCapture) {
-              mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-              nGenMoves ++;
-            }
-          } else {
-            break;
-          }
-          sqDst += nDelta;
-        }
-        sqDst += nDelta;
-        while (IN_BOARD(sqDst)) {
-          pcDst = ucpcSquares[sqDst];
-          if (pcDst != 0) {
-            if ((pcDst & pcOppSide) != 0) {
-              mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-              nGenMoves ++;
-            }
-            break;
-          }
-          sqDst += nDelta;
+    default: // PIECE_ROOK, PIECE_CANNON: look up the moves along the rank and the file
+      x = FILE_X(sqSrc);
+      y = RANK_Y(sqSrc);
+      lpsmvRank = &PreGen.smvRankMoves[x - FILE_LEFT][wBitRanks[y]];
+      lpsmvFile = &PreGen.smvFileMoves[y - RANK_TOP][wBitFiles[x]];
+      if (ucpcSquares[sqSrc] - pcSelfSide == PIECE_ROOK) {
+        nRankMask = lpsmvRank->wRookCap;
+        nFileMask = lpsmvFile->wRookCap;
+      } else {
+        nRankMask = lpsmvRank->wCannonCap;
+        nFileMask = lpsmvFile->wCannonCap;
+      }
+      if (nGenType == GEN_NON_CAPTURE) {
+        nRankMask = nFileMask = 0;
+      }
+      while (nRankMask != 0) {
+        i = COORD_XY(FILE_LEFT + LSB64(nRankMask), y);
+        nRankMask &= nRankMask - 1;
+        if ((ucpcSquares[i] & pcOppSide) != 0) {
+          mvs[nGenMoves] = MOVE(sqSrc, i);
+          nGenMoves ++;
         }
       }
-      break;
-    case PIECE_PAWN:
-      sqDst = SQUARE_FORWARD(sqSrc, sdPlayer);
-      if (IN_BOARD(sqDst)) {
-        pcDst = ucpcSquares[sqDst];
-        if (bCapture ? (pcDst & pcOppSide) != 0 : (pcDst & pcSelfSide) == 0) {
-          mvs[nGenMoves] = MOVE(sqSrc, sqDst);
+      while (nFileMask != 0) {
+        i = COORD_XY(x, RANK_TOP + LSB64(nFileMask));
+        nFileMask &= nFileMask - 1;
+        if ((ucpcSquares[i] & pcOppSide) != 0) {
+          mvs[nGenMoves] = MOVE(sqSrc, i);
           nGenMoves ++;
         }
       }
-      if (AWAY_HALF(sqSrc, sdPlayer)) {
-        for (nDelta = -1; nDelta <= 1; nDelta += 2) {
-          sqDst = sqSrc + nDelta;
-          if (IN_BOARD(sqDst)) {
-            pcDst = ucpcSquares[sqDst];
-            if (bCapture ? (pcDst & pcOppSide) != 0 : (pcDst & pcSelfSide) == 0) {
-              mvs[nGenMoves] = MOVE(sqSrc, sqDst);
-              nGenMoves ++;
-            }
-          }
+      if (nGenType != GEN_CAPTURE) {
+        nRankMask = lpsmvRank->wNonCap;
+        while (nRankMask != 0) {
+          mvs[nGenMoves] = MOVE(sqSrc, COORD_XY(FILE_LEFT + LSB64(nRankMask), y));
+          nGenMoves ++;
+          nRankMask &= nRankMask - 1;
+        }
+        nFileMask = lpsmvFile->wNonCap;
+        while (nFileMask != 0) {
+          mvs[nGenMoves] = MOVE(sqSrc, COORD_XY(x, RANK_TOP + LSB64(nFileMask)));
+          nGenMoves ++;
+          nFileMask &= nFileMask - 1;
         }
       }
-      break;
+      continue;
+    }
+    while (!bbDsts.IsEmpty()) {
+      mvs[nGenMoves] = MOVE(sqSrc, PreGen.ucsqSquares[bbDsts.PopLsb()]);
+      nGenMoves ++;
     }
   }
   return nGenMoves;
@@ -933,7 +1105,8 @@ int PositionStruct::GenerateMoves(int *mvs, BOOL bCapture) const {
 // ж߷Ƿ
 BOOL PositionStruct::LegalMove(int mv) const {
   int sqSrc, sqDst, sqPin;
-  int pcSelfSide, pcSrc, pcDst, nDelta;
+  int pcSelfSide, pcSrc, pcDst, nLineBit;
+  const SlideMoveStruct *lpsmv;
   // ж߷ǷϷҪµжϹ̣
 
   // 1. жʼǷԼ
@@ -966,26 +1139,20 @@ BOOL PositionStruct::LegalMove(int mv) const {
   case PIECE_ROOK:
   case PIECE_CANNON:
     if (SAME_RANK(sqSrc, sqDst)) {
-      nDelta = (sqDst < sqSrc ? -1 : 1);
+      lpsmv = &PreGen.smvRankMoves[FILE_X(sqSrc) - FILE_LEFT][wBitRanks[RANK_Y(sqSrc)]];
+      nLineBit = 1 << (FILE_X(sqDst) - FILE_LEFT);
     } else if (SAME_FILE(sqSrc, sqDst)) {
-      nDelta = (sqDst < sqSrc ? -16 : 16);
+      lpsmv = &PreGen.smvFileMoves[RANK_Y(sqSrc) - RANK_TOP][wBitFiles[FILE_X(sqSrc)]];
+      nLineBit = 1 << (RANK_Y(sqDst) - RANK_TOP);
     } else {
       return FALSE;
     }
-    sqPin = sqSrc + nDelta;
-    while (sqPin != sqDst && ucpcSquares[sqPin] == 0) {
-      sqPin += nDelta;
-    }
-    if (sqPin == sqDst) {
-      return pcDst == 0 || pcSrc - pcSelfSide == PIECE_ROOK;
-    } else if (pcDst != 0 && pcSrc - pcSelfSide == PIECE_CANNON) {
-      sqPin += nDelta;
-      while (sqPin != sqDst && ucpcSquares[sqPin] == 0) {
-        sqPin += nDelta;
-      }
-      return sqPin == sqDst;
+    if (pcDst == 0) {
+      return (lpsmv->wNonCap & nLineBit) != 0;
+    } else if (pcSrc - pcSelfSide == PIECE_ROOK) {
+      return (lpsmv->wRookCap & nLineBit) != 0;
     } else {
-      return FALSE;
+      return (lpsmv->wCannonCap & nLineBit) != 0;
     }
   case PIECE_PAWN:
     if (AWAY_HALF(sqDst, sdPlayer) && (sqDst == sqSrc - 1 || sqDst == sqSrc + 1)) {
@@ -999,67 +1166,60 @@ BOOL PositionStruct::LegalMove(int mv) const {
 
 // жǷ񱻽
 BOOL PositionStruct::Checked() const {
-  int i, j, sqSrc, sqDst;
-  int pcSelfSide, pcOppSide, pcDst, nDelta;
+  int i, sqSrc, sq90, x, y, nMask;
+  int pcSelfSide, pcOppSide, pcDst;
+  BitBoard bbKing;
+  const SlideMoveStruct *lpsmv;
   pcSelfSide = SIDE_TAG(sdPlayer);
   pcOppSide = OPP_SIDE_TAG(sdPlayer);
   // ҵϵ˧()жϣ
 
-  for (sqSrc = 0; sqSrc < 256; sqSrc ++) {
-    if (ucpcSquares[sqSrc] != pcSelfSide + PIECE_KING) {
-      continue;
+  bbKing = bbPieces[pcSelfSide + PIECE_KING];
+  if (bbKing.IsEmpty()) {
+    return FALSE;
+  }
+  sq90 = bbKing.PopLsb();
+  sqSrc = PreGen.ucsqSquares[sq90];
+
+  // 1. жǷ񱻶Էı()
+  if (!(PreGen.bbPawnChecks[sdPlayer][sq90] & bbPieces[pcOppSide + PIECE_PAWN]).IsEmpty()) {
+    return TRUE;
+  }
+
+  // 2. жǷ񱻶Է((ʿ)Ĳ)
+  for (i = 0; i < 4; i ++) {
+    if (ucpcSquares[sqSrc + ccAdvisorDelta[i]] == 0 &&
+        !(PreGen.bbKnightChecks[sq90][i] & bbPieces[pcOppSide + PIECE_KNIGHT]).IsEmpty()) {
+      return TRUE;
     }
+  }
 
-    // 1. жǷ񱻶Էı()
-    if (ucpcSquares[SQUARE_FORWARD(sqSrc, sdPlayer)] == pcOppSide + PIECE_PAWN) {
+  // 3. жǷ񱻶Էĳڽ(˧)
+  x = FILE_X(sqSrc);
+  y = RANK_Y(sqSrc);
+  lpsmv = &PreGen.smvRankMoves[x - FILE_LEFT][wBitRanks[y]];
+  for (nMask = lpsmv->wRookCap; nMask != 0; nMask &= nMask - 1) {
+    pcDst = ucpcSquares[COORD_XY(FILE_LEFT + LSB64(nMask), y)];
+    if (pcDst == pcOppSide + PIECE_ROOK || pcDst == pcOppSide + PIECE_KING) {
       return TRUE;
     }
-    for (nDelta = -1; nDelta <= 1; nDelta += 2) {
-      if (ucpcSquares[sqSrc + nDelta] == pcOppSide + PIECE_PAWN) {
-        return TRUE;
-      }
+  }
+  for (nMask = lpsmv->wCannonCap; nMask != 0; nMask &= nMask - 1) {
+    if (ucpcSquares[COORD_XY(FILE_LEFT + LSB64(nMask), y)] == pcOppSide + PIECE_CANNON) {
+      return TRUE;
     }
-
-    // 2. жǷ񱻶Է((ʿ)Ĳ)
-    for (i = 0; i < 4; i ++) {
-      if (ucpcSquares[sqSrc + ccAdvisorDelta[i]] != 0) {
-        continue;
-      }
-      for (j = 0; j < 2; j ++) {
-        pcDst = ucpcSquares[sqSrc + ccKnightCheckDelta[i][j]];
-        if (pcDst == pcOppSide + PIECE_KNIGHT) {
-          return TRUE;
-        }
-      }
+  }
+  lpsmv = &PreGen.smvFileMoves[y - RANK_TOP][wBitFiles[x]];
+  for (nMask = lpsmv->wRookCap; nMask != 0; nMask &= nMask - 1) {
+    pcDst = ucpcSquares[COORD_XY(x, RANK_TOP + LSB64(nMask))];
+    if (pcDst == pcOppSide + PIECE_ROOK || pcDst == pcOppSide + PIECE_KING) {
+      return TRUE;
     }
-
-    // 3. жǷ񱻶Էĳڽ(˧)
-    for (i = 0; i < 4; i ++) {
-      nDelta = ccKingDelta[i];
-      sqDst = sqSrc + nDelta;
-      while (IN_BOARD(sqDst)) {
-        pcDst = ucpcSquares[sqDst];
-        if (pcDst != 0) {
-          if (pcDst == pcOppSide + PIECE_ROOK || pcDst == pcOppSide + PIECE_KING) {
-            return TRUE;
-          }
-          break;
-        }
-        sqDst += nDelta;
-      }
-      sqDst += nDelta;
-      while (IN_BOARD(sqDst)) {
-        int pcDst = ucpcSquares[sqDst];
-        if (pcDst != 0) {
-          if (pcDst == pcOppSide + PIECE_CANNON) {
-            return TRUE;
-          }
-          break;
-        }
-        sqDst += nDelta;
-      }
+  }
+  for (nMask = lpsmv->wCannonCap; nMask != 0; nMask &= nMask - 1) {
+    if (ucpcSquares[COORD_XY(x, RANK_TOP + LSB64(nMask))] == pcOppSide + PIECE_CANNON) {
+      return TRUE;
     }
-    return FALSE;
   }
   return FALSE;
 }
@@ -1082,6 +1242,146 @@ BOOL PositionStruct::IsMate(void) {
   return TRUE;
 }
 
+// The piece values used by the static exchange evaluation (by piece type)
+static const int cnSeeValue[8] = {
+  5000, 20, 20, 90, 200, 95, 15, 0
+};
+
+// The square of the least valuable piece of side "sd" attacking "sqDst", or 0
+// if there is none. Pins (and the kings facing each other) are ignored.
+int PositionStruct::LeastAttacker(int sqDst, int sd) const {
+  int i, sq, sq90, x, y, nMask, pcSide;
+  BitBoard bbSrcs;
+  const SlideMoveStruct *lpsmvRank, *lpsmvFile;
+  pcSide = SIDE_TAG(sd);
+  sq90 = SQUARE90(sqDst);
+
+  // 1. Pawns: from behind, or from the side once across the river
+  sq = SQUARE_FORWARD(sqDst, 1 - sd);
+  if (ucpcSquares[sq] == pcSide + PIECE_PAWN) {
+    return sq;
+  }
+  if (AWAY_HALF(sqDst, sd)) {
+    for (i = -1; i <= 1; i += 2) {
+      if (ucpcSquares[sqDst + i] == pcSide + PIECE_PAWN) {
+        return sqDst + i;
+      }
+    }
+  }
+
+  // 2. Advisors and bishops (the bishop eye must be empty). "bbAdvisorMoves"
+  // and "bbKingMoves" only hold the squares within the fort, so they only give
+  // the attackers of a square within it.
+  if (IN_FORT(sqDst)) {
+    bbSrcs = PreGen.bbAdvisorMoves[sq90] & bbPieces[pcSide + PIECE_ADVISOR];
+    if (!bbSrcs.IsEmpty()) {
+      return PreGen.ucsqSquares[bbSrcs.PopLsb()];
+    }
+  }
+  for (i = 0; i < 4; i ++) {
+    if (ucpcSquares[PreGen.ucsqBishopPins[sq90][i]] == 0) {
+      bbSrcs = PreGen.bbBishopMoves[sq90][i] & bbPieces[pcSide + PIECE_BISHOP];
+      if (!bbSrcs.IsEmpty()) {
+        return PreGen.ucsqSquares[bbSrcs.PopLsb()];
+      }
+    }
+  }
+
+  // 3. Knights (with the advisor step as the knight leg, as in "Checked")
+  for (i = 0; i < 4; i ++) {
+    if (ucpcSquares[sqDst + ccAdvisorDelta[i]] == 0) {
+      bbSrcs = PreGen.bbKnightChecks[sq90][i] & bbPieces[pcSide + PIECE_KNIGHT];
+      if (!bbSrcs.IsEmpty()) {
+        return PreGen.ucsqSquares[bbSrcs.PopLsb()];
+      }
+    }
+  }
+
+  // 4. Cannons, then rooks, along the rank and the file
+  x = FILE_X(sqDst);
+  y = RANK_Y(sqDst);
+  lpsmvRank = &PreGen.smvRankMoves[x - FILE_LEFT][wBitRanks[y]];
+  lpsmvFile = &PreGen.smvFileMoves[y - RANK_TOP][wBitFiles[x]];
+  for (nMask = lpsmvRank->wCannonCap; nMask != 0; nMask &= nMask - 1) {
+    sq = COORD_XY(FILE_LEFT + LSB64(nMask), y);
+    if (ucpcSquares[sq] == pcSide + PIECE_CANNON) {
+      return sq;
+    }
+  }
+  for (nMask = lpsmvFile->wCannonCap; nMask != 0; nMask &= nMask - 1) {
+    sq = COORD_XY(x, RANK_TOP + LSB64(nMask));
+    if (ucpcSquares[sq] == pcSide + PIECE_CANNON) {
+      return sq;
+    }
+  }
+  for (nMask = lpsmvRank->wRookCap; nMask != 0; nMask &= nMask - 1) {
+    sq = COORD_XY(FILE_LEFT + LSB64(nMask), y);
+    if (ucpcSquares[sq] == pcSide + PIECE_ROOK) {
+      return sq;
+    }
+  }
+  for (nMask = lpsmvFile->wRookCap; nMask != 0; nMask &= nMask - 1) {
+    sq = COORD_XY(x, RANK_TOP + LSB64(nMask));
+    if (ucpcSquares[sq] == pcSide + PIECE_ROOK) {
+      return sq;
+    }
+  }
+
+  // 5. The king
+  if (IN_FORT(sqDst)) {
+    bbSrcs = PreGen.bbKingMoves[sq90] & bbPieces[pcSide + PIECE_KING];
+    if (!bbSrcs.IsEmpty()) {
+      return PreGen.ucsqSquares[bbSrcs.PopLsb()];
+    }
+  }
+  return 0;
+}
+
+// Static exchange evaluation of the capture "mv": the material the side to
+// move wins (or loses, if negative) when both sides keep recapturing on the
+// destination with their least valuable pieces, each side being free to stop.
+// The capturing pieces are taken off the board as they go, so that the rooks
+// and cannons behind them (or screened by them) come into play, and are put
+// back at the end.
+int PositionStruct::See(int mv) {
+  int sqDst, sqSrc, pc, nDepth, nRemoved, sd;
+  int vlGains[32], sqsRemoved[32], pcsRemoved[32];
+
+  sqDst = DST(mv);
+  sqSrc = SRC(mv);
+  vlGains[0] = cnSeeValue[ucpcSquares[sqDst] & 7];
+  nDepth = nRemoved = 0;
+  sd = sdPlayer;
+  do {
+    pc = ucpcSquares[sqSrc];
+    nDepth ++;
+    // What has been won if this capture is answered by a recapture
+    vlGains[nDepth] = cnSeeValue[pc & 7] - vlGains[nDepth - 1];
+    if (std::max(-vlGains[nDepth - 1], vlGains[nDepth]) < 0) {
+      break; // Neither side can gain by going on
+    }
+    sqsRemoved[nRemoved] = sqSrc;
+    pcsRemoved[nRemoved] = pc;
+    nRemoved ++;
+    ucpcSquares[sqSrc] = 0;
+    FlipBits(sqSrc, pc);
+    sd = 1 - sd;
+    sqSrc = LeastAttacker(sqDst, sd);
+  } while (sqSrc != 0 && nDepth < 31);
+
+  while (nRemoved > 0) {
+    nRemoved --;
+    ucpcSquares[sqsRemoved[nRemoved]] = pcsRemoved[nRemoved];
+    FlipBits(sqsRemoved[nRemoved], pcsRemoved[nRemoved]);
+  }
+
+  // Each side stops recapturing if that is better for it
+  while (-- nDepth > 0) {
+    vlGains[nDepth - 1] = -std::max(-vlGains[nDepth - 1], vlGains[nDepth]);
+  }
+  return vlGains[0];
+}
+
 // ظ
 int PositionStruct::RepStatus(int nRecur) const {
   BOOL bSelfSide, bPerpCheck, bOppPerpCheck;
@@ -1124,8 +1424,6 @@ void PositionStruct::Mirror(PositionStruct &posMirror) const {
   posMirror.SetIrrev();
 }
 
-static PositionStruct pos; // ʵ
-
 // ͼνйصȫֱ
 #if 0
 static struct {
@@ -1142,100 +1440,328 @@ static struct {
 struct HashItem {
   BYTE ucDepth, ucFlag;
   short svl;
-  WORD wmv, wReserved;
+  WORD wmv;
+  BYTE ucAge, ucReserved;  // The search generation which last used this entry
   DWORD dwLock0, dwLock1;
 };
 
+// A hash table slot, shared by all the search threads of an engine.
+// It is read and written without any lock: the lock words are stored XOR-ed
+// with the data word, so a slot torn by two simultaneous writers simply fails
+// the lock check of the next "ProbeHash".
+struct HashSlot {
+  std::atomic<uint64_t> qwData, qwLock;
+
+  void Load(HashItem &hsh) const {
+    uint64_t qwData_, qwLock_;
+    qwData_ = qwData.load(std::memory_order_relaxed);
+    qwLock_ = qwLock.load(std::memory_order_relaxed) ^ qwData_;
+    memcpy(&hsh, &qwData_, sizeof(qwData_));
+    hsh.dwLock0 = (DWORD) qwLock_;
+    hsh.dwLock1 = (DWORD) (qwLock_ >> 32);
+  }
+  void Store(const HashItem &hsh) {
+    uint64_t qwData_;
+    memcpy(&qwData_, &hsh, sizeof(qwData_));
+    qwData.store(qwData_, std::memory_order_relaxed);
+    qwLock.store((hsh.dwLock0 | ((uint64_t) hsh.dwLock1 << 32)) ^ qwData_,
+                 std::memory_order_relaxed);
+  }
+};
+
 // ֿṹ
 struct BookItem {
   DWORD dwLock;
   WORD wmv, wvl;
 };
 
-// йصȫֱ
-static struct {
+// The opening book, sorted by "dwLock". It is read-only, so it is opened once
+// per process and shared by all the engines (and all their threads).
+struct BookStruct {
+  const BookItem *lpTable;
+  int nSize;
+  BookItem *lpCopy;              // Our own copy, if the file was not mapped
+
+  BookStruct(const char *szFileName);
+};
+
+static const BookStruct &SharedBook(void) {
+  static const BookStruct s_book(s_opening_book);
+  return s_book;
+}
+
+// The state of one search: the position being searched, plus the move
+// ordering tables that belong to it.
+struct SearchStruct {
+  EngineStruct *lpEngine;        // The engine this search belongs to
+  PositionStruct pos;            // ʵ
   int mvResult;                  // ߵ
+  std::atomic<bool> bTimed;      // Does this search watch the clock (main search only)?
+  int nNodes;                    // Nodes searched, for polling the clock
   int nHistoryTable[65536];      // ʷ
   int mvKillers[LIMIT_DEPTH][2]; // ɱ߷
-  HashItem HashTable[HASH_SIZE]; // û
-  int nBookSize;                 // ֿС
-  BookItem BookTable[BOOK_SIZE]; // ֿ
-} Search;
 
-// װ뿪ֿ
+  int SearchBook(void);
+  int ProbeHash(int vlAlpha, int vlBeta, int nDepth, int &mv);
+  void RecordHash(int nFlag, int vl, int nDepth, int mv);
+  void SetBestMove(int mv, int nDepth);
+  int SearchQuiesc(int vlAlpha, int vlBeta);
+  int SearchFull(int vlAlpha, int vlBeta, int nDepth, BOOL bNoNull = FALSE);
+  int SearchRoot(int nDepth);
+  void SearchMain(BOOL bPonder = FALSE);
+  void SearchHelper(int nHelper);
+  BOOL Stopped(void) const;
+  void AgeTables(void);
+  void PollTime(void);
+};
 
-#include <fstream>   // file I/O
-#include <iomanip>
-static void LoadBook(void) {
-    /* CREDITS:
-     *    How to read in an entire binary file
-     *        http://www.cplusplus.com/doc/tutorial/files.html
-     */
+// йصȫֱ
+struct XQWLight::EngineStruct {
+  int nSearchDepth;              // Search Depth
+  int nMoveTime;                 // Time per move (ms), or 0
+  int nGameTime;                 // Time left on our clock (ms), or 0
+  int nIncrement;                // Increment per move (ms)
+  int nMovesToGo;                // Moves to the next time control, or 0 (sudden death)
+  std::chrono::steady_clock::time_point tpSoft;  // No new iteration after this
+  std::chrono::steady_clock::time_point tpHard;  // The search is aborted at this
+  HashSlot *lpHashTable;         // û
+  size_t nHashMask;              // The number of hash slots, minus 1
+  BOOL bHashMapped;              // Is the hash table mmap'ed (rather than new'ed)?
+  int nHashSize;                 // The wanted hash table size (MB)
+  const BookStruct *lpBook;      // ֿ (shared)
+  SearchStruct Search;           // The search (and the current position)
+  int nAge;                      // The current search generation (0-255)
+  int nThreads;                  // Number of search threads (lazy SMP)
+  SearchStruct *lpHelpers;       // The "nThreads - 1" helper searches
+  std::atomic<bool> bStop;       // Tells the helper threads to stop
+  BOOL bPonder;                  // Ponder (in the opponent's time)?
+  std::thread thPonder;          // Runs "Search" while pondering
+  int mvPonder;                  // The expected reply being pondered on
+  BOOL bPonderHit;               // The opponent played "mvPonder"
+
+  ~EngineStruct() {
+    StopPonder();
+    delete [] lpHelpers;
+    FreeHash();
+  }
+  void SetThreads(int nThreads_);
+  void AllocHash(void);
+  void FreeHash(void);
+  BOOL AllocateTime(void);
+  void StartPonder(void);
+  void StopPonder(void);
+  void PonderHit(void);
+};
 
-    using namespace std;
-    ifstream fp_in;  // declarations of streams fp_in and fp_out
-    fp_in.open(s_opening_book, ios::in|ios::binary|ios::ate);
-                                // open and read til END
-    if (!fp_in.is_open()) {
-        return;
+// Has the search been told to stop (and unwind without recording anything)?
+inline BOOL SearchStruct::Stopped(void) const {
+  return lpEngine->bStop.load(std::memory_order_relaxed);
+}
+
+// Work out the deadlines of the search that starts now, from the game clock
+// (a share of the time left, plus most of the increment) and/or the time per
+// move. The soft deadline is about when the search should end: no iteration
+// is started after it. The hard deadline is when the search is aborted, even
+// in the middle of an iteration. Returns FALSE if the search is not timed.
+BOOL EngineStruct::AllocateTime(void) {
+  int nSoft, nHard, nMovesLeft;
+  std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+  if (nGameTime > 0) {
+    nMovesLeft = (nMovesToGo > 0 ? std::min(nMovesToGo, TIME_MOVES_LEFT) : TIME_MOVES_LEFT);
+    nSoft = nGameTime / nMovesLeft + nIncrement * 3 / 4;
+    nHard = std::min(nSoft * 4, nGameTime - TIME_MARGIN);
+    if (nMoveTime > 0) {
+      nHard = std::min(nHard, nMoveTime);
     }
+  } else if (nMoveTime > 0) {
+    nSoft = nMoveTime / 2;
+    nHard = nMoveTime;
+  } else {
+    return FALSE;
+  }
+  nHard = std::max(nHard, 1);
+  nSoft = std::min(nSoft, nHard);
+  tpSoft = tpStart + std::chrono::milliseconds(nSoft);
+  tpHard = tpStart + std::chrono::milliseconds(nHard);
+  return TRUE;
+}
 
-    ifstream::pos_type size = fp_in.tellg();
-    Search.nBookSize = size / sizeof(BookItem);
-    if (Search.nBookSize > BOOK_SIZE) {
-      Search.nBookSize = BOOK_SIZE;
+void EngineStruct::SetThreads(int nThreads_) {
+  int i;
+  delete [] lpHelpers;
+  lpHelpers = NULL;
+  nThreads = nThreads_;
+  if (nThreads > 1) {
+    lpHelpers = new SearchStruct[nThreads - 1]();
+    for (i = 0; i < nThreads - 1; i ++) {
+      lpHelpers[i].lpEngine = this;
     }
-    fp_in.seekg (0, ios::beg);
-    fp_in.read ((char*)Search.BookTable, Search.nBookSize * sizeof(BookItem));
-    fp_in.close();   // close the streams
-    
-    printf("%s: Success opening book Size = [%d (of %zu)].\n",
-        __FUNCTION__, Search.nBookSize, sizeof(BookItem));
+  }
 }
 
+// Allocate the hash table with the largest power-of-two number of slots that
+// fits in "nHashSize" MB. On Linux, tables of 2 MB or more are mmap'ed on a
+// 2 MB boundary and advised to be backed by transparent huge pages, which
+// saves most of the TLB misses of the (random) hash probes. If the memory is
+// not available, smaller tables are tried, down to 1 MB.
+void EngineStruct::AllocHash(void) {
+  size_t nSlots, nBytes;
+
+  FreeHash();
+  nSlots = 1;
+  while (nSlots * 2 * sizeof(HashSlot) <= ((size_t) nHashSize << 20)) {
+    nSlots *= 2;
+  }
+  for (; lpHashTable == NULL; nSlots /= 2) {
+    nBytes = nSlots * sizeof(HashSlot);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    const size_t HUGE_PAGE_SIZE = 2 << 20;
+    if (nBytes >= HUGE_PAGE_SIZE) {
+      // Over-allocate by one huge page, then give back the unaligned ends
+      void *lp = mmap(NULL, nBytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (lp != MAP_FAILED) {
+        char *lpStart = (char *) lp;
+        char *lpAligned = (char *) (((uintptr_t) lpStart + HUGE_PAGE_SIZE - 1) & ~(uintptr_t) (HUGE_PAGE_SIZE - 1));
+        if (lpAligned > lpStart) {
+          munmap(lpStart, lpAligned - lpStart);
+        }
+        if (lpStart + HUGE_PAGE_SIZE > lpAligned) {
+          munmap(lpAligned + nBytes, lpStart + HUGE_PAGE_SIZE - lpAligned);
+        }
+        madvise(lpAligned, nBytes, MADV_HUGEPAGE); // Only a hint: may fail
+        lpHashTable = (HashSlot *) lpAligned;      // Zero-filled by mmap
+        bHashMapped = TRUE;
+      }
+    }
+#endif
+    if (lpHashTable == NULL) {
+      lpHashTable = new (std::nothrow) HashSlot[nSlots]();
+      bHashMapped = FALSE;
+    }
+    if (lpHashTable != NULL) {
+      nHashMask = nSlots - 1;
+    } else if (nSlots * sizeof(HashSlot) <= (1 << 20)) {
+      throw std::bad_alloc();
+    }
+  }
+  printf("%s: Hash table = [%lu] MB.\n", __FUNCTION__,
+         (unsigned long) ((nHashMask + 1) * sizeof(HashSlot) >> 20));
+}
+
+void EngineStruct::FreeHash(void) {
+  if (lpHashTable == NULL) {
+    return;
+  }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (bHashMapped) {
+    munmap(lpHashTable, (nHashMask + 1) * sizeof(HashSlot));
+  } else
+#endif
+  {
+    delete [] lpHashTable;
+  }
+  lpHashTable = NULL;
+}
+
+#include <fstream>   // file I/O
+#include <iomanip>
 static int CompareBook(const void *lpbk1, const void *lpbk2) {
   DWORD dw1, dw2;
-  dw1 = ((BookItem *) lpbk1)->dwLock;
-  dw2 = ((BookItem *) lpbk2)->dwLock;
+  dw1 = ((const BookItem *) lpbk1)->dwLock;
+  dw2 = ((const BookItem *) lpbk2)->dwLock;
   return dw1 > dw2 ? 1 : dw1 < dw2 ? -1 : 0;
 }
 
+// װ뿪ֿ
+// Map the book file into memory (read-only, and shared with the other
+// processes using it), falling back to reading it into our own copy.
+// A book which is not sorted is sorted into our own copy.
+BookStruct::BookStruct(const char *szFileName) : lpTable(NULL), nSize(0), lpCopy(NULL) {
+  int i;
+#if !defined(_WIN32)
+  struct stat st;
+  int fd = open(szFileName, O_RDONLY);
+  if (fd != -1) {
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(BookItem)) {
+      void *lp = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (lp != MAP_FAILED) {
+        lpTable = (const BookItem *) lp;
+        nSize = st.st_size / sizeof(BookItem);
+      }
+    }
+    close(fd);
+  }
+#endif
+  if (lpTable == NULL) {
+    using namespace std;
+    ifstream fp_in(szFileName, ios::in|ios::binary|ios::ate);
+    if (!fp_in.is_open()) {
+      return;
+    }
+    nSize = (int) (fp_in.tellg() / sizeof(BookItem));
+    lpCopy = new BookItem[nSize];
+    fp_in.seekg(0, ios::beg);
+    fp_in.read((char*)lpCopy, nSize * sizeof(BookItem));
+    lpTable = lpCopy;
+  }
+
+  for (i = 1; i < nSize; i ++) {
+    if (lpTable[i - 1].dwLock > lpTable[i].dwLock) {
+      break;
+    }
+  }
+  if (i < nSize) {
+    if (lpCopy == NULL) {
+      lpCopy = new BookItem[nSize];
+      memcpy(lpCopy, lpTable, nSize * sizeof(BookItem));
+      lpTable = lpCopy;
+    }
+    qsort(lpCopy, nSize, sizeof(BookItem), CompareBook);
+  }
+
+  printf("%s: Success opening book Size = [%d (of %zu)].\n",
+      __FUNCTION__, nSize, sizeof(BookItem));
+}
+
 // ֿ
-static int SearchBook(void) {
+int SearchStruct::SearchBook(void) {
   int i, vl, nBookMoves, mv;
   int mvs[MAX_GEN_MOVES], vls[MAX_GEN_MOVES];
   BOOL bMirror;
-  BookItem bkToSearch, *lpbk;
+  BookItem bkToSearch;
+  const BookItem *lpbk;
+  const BookStruct &book = *lpEngine->lpBook;
   PositionStruct posMirror;
   // ֿĹ¼
 
   // 1. ûпֿ⣬
-  if (Search.nBookSize == 0) {
+  if (book.nSize == 0) {
     return 0;
   }
   // 2. ǰ
   bMirror = FALSE;
   bkToSearch.dwLock = pos.zobr.dwLock1;
-  lpbk = (BookItem *) bsearch(&bkToSearch, Search.BookTable, Search.nBookSize, sizeof(BookItem), CompareBook);
+  lpbk = (const BookItem *) bsearch(&bkToSearch, book.lpTable, book.nSize, sizeof(BookItem), CompareBook);
   // 3. ûҵôǰľ
   if (lpbk == NULL) {
     bMirror = TRUE;
     pos.Mirror(posMirror);
     bkToSearch.dwLock = posMirror.zobr.dwLock1;
-    lpbk = (BookItem *) bsearch(&bkToSearch, Search.BookTable, Search.nBookSize, sizeof(BookItem), CompareBook);
+    lpbk = (const BookItem *) bsearch(&bkToSearch, book.lpTable, book.nSize, sizeof(BookItem), CompareBook);
   }
   // 4. Ҳûҵ
   if (lpbk == NULL) {
     return 0;
   }
   // 5. ҵǰһֿ
-  while (lpbk >= Search.BookTable && lpbk->dwLock == bkToSearch.dwLock) {
+  while (lpbk >= book.lpTable && lpbk->dwLock == bkToSearch.dwLock) {
     lpbk --;
   }
   lpbk ++;
   // 6. ߷ͷֵд뵽"mvs""vls"
   vl = nBookMoves = 0;
-  while (lpbk < Search.BookTable + Search.nBookSize && lpbk->dwLock == bkToSearch.dwLock) {
+  while (lpbk < book.lpTable + book.nSize && lpbk->dwLock == bkToSearch.dwLock) {
     mv = (bMirror ? MIRROR_MOVE(lpbk->wmv) : lpbk->wmv);
     if (pos.LegalMove(mv)) {
       mvs[nBookMoves] = mv;
@@ -1263,15 +1789,19 @@ static int SearchBook(void) {
 }
 
 // ȡû
-static int ProbeHash(int vlAlpha, int vlBeta, int nDepth, int &mv) {
+int SearchStruct::ProbeHash(int vlAlpha, int vlBeta, int nDepth, int &mv) {
   BOOL bMate; // ɱ־ɱ壬ôҪ
   HashItem hsh;
 
-  hsh = Search.HashTable[pos.zobr.dwKey & (HASH_SIZE - 1)];
+  lpEngine->lpHashTable[pos.zobr.dwKey & lpEngine->nHashMask].Load(hsh);
   if (hsh.dwLock0 != pos.zobr.dwLock0 || hsh.dwLock1 != pos.zobr.dwLock1) {
     mv = 0;
     return -MATE_VALUE;
   }
+  if (hsh.ucAge != lpEngine->nAge) {
+    hsh.ucAge = lpEngine->nAge;
+    lpEngine->lpHashTable[pos.zobr.dwKey & lpEngine->nHashMask].Store(hsh);
+  }
   mv = hsh.wmv;
   bMate = FALSE;
   if (hsh.svl > WIN_VALUE) {
@@ -1299,14 +1829,15 @@ static int ProbeHash(int vlAlpha, int vlBeta, int nDepth, int &mv) {
 };
 
 // û
-static void RecordHash(int nFlag, int vl, int nDepth, int mv) {
+void SearchStruct::RecordHash(int nFlag, int vl, int nDepth, int mv) {
   HashItem hsh;
-  hsh = Search.HashTable[pos.zobr.dwKey & (HASH_SIZE - 1)];
-  if (hsh.ucDepth > nDepth) {
+  lpEngine->lpHashTable[pos.zobr.dwKey & lpEngine->nHashMask].Load(hsh);
+  if (hsh.ucAge == lpEngine->nAge && hsh.ucDepth > nDepth) {
     return;
   }
   hsh.ucFlag = nFlag;
   hsh.ucDepth = nDepth;
+  hsh.ucAge = lpEngine->nAge;
   if (vl > WIN_VALUE) {
     if (mv == 0 && vl <= BAN_VALUE) {
       return; // ܵĲȶԣûŷ˳
@@ -1323,7 +1854,7 @@ static void RecordHash(int nFlag, int vl, int nDepth, int mv) {
   hsh.wmv = mv;
   hsh.dwLock0 = pos.zobr.dwLock0;
   hsh.dwLock1 = pos.zobr.dwLock1;
-  Search.HashTable[pos.zobr.dwKey & (HASH_SIZE - 1)] = hsh;
+  lpEngine->lpHashTable[pos.zobr.dwKey & lpEngine->nHashMask].Store(hsh);
 };
 
 // MVV/LVAÿļֵ
@@ -1334,99 +1865,163 @@ static BYTE cucMvvLva[24] = {
 };
 
 // MVV/LVAֵ
-inline int MvvLva(int mv) {
+inline int MvvLva(const PositionStruct &pos, int mv) {
   return (cucMvvLva[pos.ucpcSquares[DST(mv)]] << 3) - cucMvvLva[pos.ucpcSquares[SRC(mv)]];
 }
 
-// "qsort"MVV/LVAֵıȽϺ
-static int CompareMvvLva(const void *lpmv1, const void *lpmv2) {
-  return MvvLva(*(int *) lpmv2) - MvvLva(*(int *) lpmv1);
-}
-
-// "qsort"ʷıȽϺ
-static int CompareHistory(const void *lpmv1, const void *lpmv2) {
-  return Search.nHistoryTable[*(int *) lpmv2] - Search.nHistoryTable[*(int *) lpmv1];
-}
-
-
 // ߷׶
 const int PHASE_HASH = 0;
-const int PHASE_KILLER_1 = 1;
-const int PHASE_KILLER_2 = 2;
-const int PHASE_GEN_MOVES = 3;
-const int PHASE_REST = 4;
+const int PHASE_GEN_CAPS = 1;
+const int PHASE_GOOD_CAPS = 2;
+const int PHASE_KILLER_1 = 3;
+const int PHASE_KILLER_2 = 4;
+const int PHASE_GEN_QUIETS = 5;
+const int PHASE_QUIETS = 6;
+const int PHASE_BAD_CAPS = 7;
+const int PHASE_DONE = 8;
 
 // ߷ṹ
 struct SortStruct {
   int mvHash, mvKiller1, mvKiller2; // û߷ɱ߷
   int nPhase, nIndex, nGenMoves;    // ǰ׶Σǰõڼ߷ܹм߷
+  int nBadCaps;                     // The losing captures, put aside at the front of "mvs"
+  BOOL bQuiesc;                     // Only the winning (and even) captures?
   int mvs[MAX_GEN_MOVES];           // е߷
+  int nVals[MAX_GEN_MOVES];         // The MVV/LVA (captures) or history (quiet moves) values
+  SearchStruct *lpSearch;           // The search this belongs to
 
-  void Init(int mvHash_) { // ʼ趨û߷ɱ߷
+  void Init(SearchStruct &search, int mvHash_) { // ʼ趨û߷ɱ߷
+    lpSearch = &search;
     mvHash = mvHash_;
-    mvKiller1 = Search.mvKillers[pos.nDistance][0];
-    mvKiller2 = Search.mvKillers[pos.nDistance][1];
+    mvKiller1 = search.mvKillers[search.pos.nDistance][0];
+    mvKiller2 = search.mvKillers[search.pos.nDistance][1];
     nPhase = PHASE_HASH;
+    bQuiesc = FALSE;
+  }
+  void InitQuiesc(SearchStruct &search) { // For the quiescence search: the captures, but not the losing ones
+    lpSearch = &search;
+    mvHash = mvKiller1 = mvKiller2 = 0;
+    nPhase = PHASE_GEN_CAPS;
+    bQuiesc = TRUE;
+  }
+  int PickBest(void) {              // Take the move of the highest value out of those left
+    int i, nBest, n;
+    nBest = nIndex;
+    for (i = nIndex + 1; i < nGenMoves; i ++) {
+      if (nVals[i] > nVals[nBest]) {
+        nBest = i;
+      }
+    }
+    n = mvs[nBest], mvs[nBest] = mvs[nIndex], mvs[nIndex] = n;
+    n = nVals[nBest], nVals[nBest] = nVals[nIndex], nVals[nIndex] = n;
+    nIndex ++;
+    return mvs[nIndex - 1];
+  }
+  BOOL KillerOkay(int mv) const {   // A quiet killer move, which is legal here
+    return mv != mvHash && mv != 0 && lpSearch->pos.ucpcSquares[DST(mv)] == 0 &&
+        lpSearch->pos.LegalMove(mv);
   }
   int Next(void); // õһ߷
 };
 
 // õһ߷
 int SortStruct::Next(void) {
-  int mv;
+  int i, mv;
+  PositionStruct &pos = lpSearch->pos;
   switch (nPhase) {
   // "nPhase"ʾŷɽ׶ΣΪ
 
   // 0. ûŷɺһ׶Σ
   case PHASE_HASH:
-    nPhase = PHASE_KILLER_1;
+    nPhase = PHASE_GEN_CAPS;
     if (mvHash != 0) {
       return mvHash;
     }
     // ɣû"break"ʾ"switch"һ"case"ִһ"case"ͬ
 
-  // 1. ɱŷ(һɱŷ)ɺһ׶Σ
+  // 1. Generate the captures, valued by MVV/LVA;
+  case PHASE_GEN_CAPS:
+    nPhase = PHASE_GOOD_CAPS;
+    nGenMoves = pos.GenerateMoves(mvs, GEN_CAPTURE);
+    for (i = 0; i < nGenMoves; i ++) {
+      nVals[i] = MvvLva(pos, mvs[i]);
+    }
+    nIndex = nBadCaps = 0;
+
+  // 2. The captures which do not lose material (by SEE), best first. The
+  //    losing ones are put aside for the end (or, in quiescence, dropped);
+  case PHASE_GOOD_CAPS:
+    while (nIndex < nGenMoves) {
+      mv = PickBest();
+      if (mv == mvHash) {
+        continue;
+      }
+      if (cnSeeValue[pos.ucpcSquares[DST(mv)] & 7] < cnSeeValue[pos.ucpcSquares[SRC(mv)] & 7] &&
+          pos.See(mv) < 0) {
+        mvs[nBadCaps] = mv; // (over a move already taken)
+        nBadCaps ++;
+        continue;
+      }
+      return mv;
+    }
+    if (bQuiesc) {
+      nPhase = PHASE_DONE;
+      return 0;
+    }
+
+  // 3. ɱŷ(һɱŷ)ɺһ׶Σ
   case PHASE_KILLER_1:
     nPhase = PHASE_KILLER_2;
-    if (mvKiller1 != mvHash && mvKiller1 != 0 && pos.LegalMove(mvKiller1)) {
+    if (KillerOkay(mvKiller1)) {
       return mvKiller1;
     }
 
-  // 2. ɱŷ(ڶɱŷ)ɺһ׶Σ
+  // 4. ɱŷ(ڶɱŷ)ɺһ׶Σ
   case PHASE_KILLER_2:
-    nPhase = PHASE_GEN_MOVES;
-    if (mvKiller2 != mvHash && mvKiller2 != 0 && pos.LegalMove(mvKiller2)) {
+    nPhase = PHASE_GEN_QUIETS;
+    if (mvKiller2 != mvKiller1 && KillerOkay(mvKiller2)) {
       return mvKiller2;
     }
 
-  // 3. ŷɺһ׶Σ
-  case PHASE_GEN_MOVES:
-    nPhase = PHASE_REST;
-    nGenMoves = pos.GenerateMoves(mvs);
-    qsort(mvs, nGenMoves, sizeof(int), CompareHistory);
-    nIndex = 0;
+  // 5. Generate the quiet moves (after the losing captures), valued by the history table;
+  case PHASE_GEN_QUIETS:
+    nPhase = PHASE_QUIETS;
+    nGenMoves = nBadCaps + pos.GenerateMoves(mvs + nBadCaps, GEN_NON_CAPTURE);
+    for (i = nBadCaps; i < nGenMoves; i ++) {
+      nVals[i] = lpSearch->nHistoryTable[mvs[i]];
+    }
+    nIndex = nBadCaps;
 
-  // 4. ʣŷʷ
-  case PHASE_REST:
+  // 6. ʣŷʷ (picking the best one at a time, as a cut-off makes the rest useless);
+  case PHASE_QUIETS:
     while (nIndex < nGenMoves) {
-      mv = mvs[nIndex];
-      nIndex ++;
+      mv = PickBest();
       if (mv != mvHash && mv != mvKiller1 && mv != mvKiller2) {
         return mv;
       }
     }
+    nPhase = PHASE_BAD_CAPS;
+    nIndex = 0;
+
+  // 7. The losing captures;
+  case PHASE_BAD_CAPS:
+    if (nIndex < nBadCaps) {
+      nIndex ++;
+      return mvs[nIndex - 1];
+    }
+    nPhase = PHASE_DONE;
 
-  // 5. ûŷˣ㡣
+  // 8. ûŷˣ㡣
   default:
     return 0;
   }
 }
 
 // ߷Ĵ
-inline void SetBestMove(int mv, int nDepth) {
+inline void SearchStruct::SetBestMove(int mv, int nDepth) {
   int *lpmvKillers;
-  Search.nHistoryTable[mv] += nDepth * nDepth;
-  lpmvKillers = Search.mvKillers[pos.nDistance];
+  nHistoryTable[mv] += nDepth * nDepth;
+  lpmvKillers = mvKillers[pos.nDistance];
   if (lpmvKillers[0] != mv) {
     lpmvKillers[1] = lpmvKillers[0];
     lpmvKillers[0] = mv;
@@ -1434,12 +2029,15 @@ inline void SetBestMove(int mv, int nDepth) {
 }
 
 // ̬(Quiescence)
-static int SearchQuiesc(int vlAlpha, int vlBeta) {
-  int i, nGenMoves;
-  int vl, vlBest;
-  int mvs[MAX_GEN_MOVES];
+int SearchStruct::SearchQuiesc(int vlAlpha, int vlBeta) {
+  int mv, vl, vlBest;
+  SortStruct Sort;
   // һ̬Ϊ¼׶
 
+  if (++ nNodes % TIME_POLL_NODES == 0) {
+    PollTime();
+  }
+
   // 1. ظ
   vl = pos.RepStatus();
   if (vl != 0) {
@@ -1456,8 +2054,7 @@ static int SearchQuiesc(int vlAlpha, int vlBeta) {
 
   if (pos.InCheck()) {
     // 4. ȫ߷
-    nGenMoves = pos.GenerateMoves(mvs);
-    qsort(mvs, nGenMoves, sizeof(int), CompareHistory);
+    Sort.Init(*this, 0);
   } else {
 
     // 5. 
@@ -1473,15 +2070,18 @@ static int SearchQuiesc(int vlAlpha, int vlBeta) {
     }
 
     // 6. ûнضϣɳ߷
-    nGenMoves = pos.GenerateMoves(mvs, GEN_CAPTURE);
-    qsort(mvs, nGenMoves, sizeof(int), CompareMvvLva);
+    //    (but not those which lose material, which keeps the exchanges of cannons in check)
+    Sort.InitQuiesc(*this);
   }
 
   // 7. һЩ߷еݹ
-  for (i = 0; i < nGenMoves; i ++) {
-    if (pos.MakeMove(mvs[i])) {
+  while ((mv = Sort.Next()) != 0) {
+    if (pos.MakeMove(mv)) {
       vl = -SearchQuiesc(-vlBeta, -vlAlpha);
       pos.UndoMakeMove();
+      if (Stopped()) {
+        return 0;
+      }
 
       // 8. Alpha-BetaСжϺͽض
       if (vl > vlBest) {    // ҵֵ(ȷAlphaPVBeta߷)
@@ -1504,12 +2104,16 @@ static int SearchQuiesc(int vlAlpha, int vlBeta) {
 const BOOL NO_NULL = TRUE;
 
 // ߽(Fail-Soft)Alpha-Beta
-static int SearchFull(int vlAlpha, int vlBeta, int nDepth, BOOL bNoNull = FALSE) {
+int SearchStruct::SearchFull(int vlAlpha, int vlBeta, int nDepth, BOOL bNoNull) {
   int nHashFlag, vl, vlBest;
   int mv, mvBest, mvHash, nNewDepth;
   SortStruct Sort;
   // һAlpha-BetaȫΪ¼׶
 
+  if (++ nNodes % TIME_POLL_NODES == 0) {
+    PollTime();
+  }
+
   // 1. ˮƽߣþ̬(ע⣺ڿղüȿС)
   if (nDepth <= 0) {
     return SearchQuiesc(vlAlpha, vlBeta);
@@ -1548,7 +2152,7 @@ static int SearchFull(int vlAlpha, int vlBeta, int nDepth, BOOL bNoNull = FALSE)
   mvBest = 0;           // ֪ǷBeta߷PV߷Ա㱣浽ʷ
 
   // 3. ʼ߷ṹ
-  Sort.Init(mvHash);
+  Sort.Init(*this, mvHash);
 
   // 4. һЩ߷еݹ
   while ((mv = Sort.Next()) != 0) {
@@ -1565,6 +2169,9 @@ static int SearchFull(int vlAlpha, int vlBeta, int nDepth, BOOL bNoNull = FALSE)
         }
       }
       pos.UndoMakeMove();
+      if (Stopped()) {
+        return 0;
+      }
 
       // 5. Alpha-BetaСжϺͽض
       if (vl > vlBest) {    // ҵֵ(ȷAlphaPVBeta߷)
@@ -1598,12 +2205,12 @@ static int SearchFull(int vlAlpha, int vlBeta, int nDepth, BOOL bNoNull = FALSE)
 }
 
 // ڵAlpha-Beta
-static int SearchRoot(int nDepth) {
+int SearchStruct::SearchRoot(int nDepth) {
   int vl, vlBest, mv, nNewDepth;
   SortStruct Sort;
 
   vlBest = -MATE_VALUE;
-  Sort.Init(Search.mvResult);
+  Sort.Init(*this, mvResult);
   while ((mv = Sort.Next()) != 0) {
     if (pos.MakeMove(mv)) {
       nNewDepth = pos.InCheck() ? nDepth : nDepth - 1;
@@ -1616,36 +2223,44 @@ static int SearchRoot(int nDepth) {
         }
       }
       pos.UndoMakeMove();
+      if (Stopped()) {
+        return vlBest;
+      }
       if (vl > vlBest) {
         vlBest = vl;
-        Search.mvResult = mv;
+        mvResult = mv;
         if (vlBest > -WIN_VALUE && vlBest < WIN_VALUE) {
           vlBest += (rand() & RANDOM_MASK) - (rand() & RANDOM_MASK);
         }
       }
     }
   }
-  RecordHash(HASH_PV, vlBest, nDepth, Search.mvResult);
-  SetBestMove(Search.mvResult, nDepth);
+  RecordHash(HASH_PV, vlBest, nDepth, mvResult);
+  SetBestMove(mvResult, nDepth);
   return vlBest;
 }
 
 // 
-static void SearchMain(void) {
-  int i, t, vl, nGenMoves;
+void SearchStruct::SearchMain(BOOL bPonder) {
+  int i, vl, nGenMoves, mvLast;
   int mvs[MAX_GEN_MOVES];
+  float elapse;
+  std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+  std::vector<std::thread> helpers;
 
   // ʼ
-  memset(Search.nHistoryTable, 0, 65536 * sizeof(int));       // ʷ
-  memset(Search.mvKillers, 0, LIMIT_DEPTH * 2 * sizeof(int)); // ɱ߷
-  memset(Search.HashTable, 0, HASH_SIZE * sizeof(HashItem));  // û
-  t = clock();       // ʼʱ
+  AgeTables();                                                  // Age the history and killer tables
+  lpEngine->nAge = (lpEngine->nAge + 1) & 255;                  // Start a new hash generation
+  if (!bPonder) {                                               // ʼʱ
+    bTimed = lpEngine->AllocateTime();                          // (when pondering, "PonderHit" does it)
+  }
+  nNodes = 0;
   pos.nDistance = 0; // ʼ
 
   // ֿ
-  Search.mvResult = SearchBook();
-  if (Search.mvResult != 0) {
-    pos.MakeMove(Search.mvResult);
+  mvResult = SearchBook();
+  if (mvResult != 0) {
+    pos.MakeMove(mvResult);
     if (pos.RepStatus(3) == 0) {
       pos.UndoMakeMove();
       return;
@@ -1659,7 +2274,7 @@ static void SearchMain(void) {
   for (i = 0; i < nGenMoves; i ++) {
     if (pos.MakeMove(mvs[i])) {
       pos.UndoMakeMove();
-      Search.mvResult = mvs[i];
+      mvResult = mvs[i];
       vl ++;
     }
   }
@@ -1667,84 +2282,401 @@ static void SearchMain(void) {
     return;
   }
 
+  // Start the lazy-SMP helpers, which share nothing but the hash table with us
+  for (i = 1; i < lpEngine->nThreads; i ++) {
+    SearchStruct &helper = lpEngine->lpHelpers[i - 1];
+    helper.pos = pos;
+    helpers.push_back(std::thread(&SearchStruct::SearchHelper, &helper, i));
+  }
+
   // 
-  for (i = 1; i <= s_search_depth; i ++) {
+  mvLast = mvResult;
+  for (i = 1; i <= lpEngine->nSearchDepth; i ++) {
     vl = SearchRoot(i);
+    // Aborted at the hard deadline: play the move of the last complete iteration
+    if (Stopped()) {
+      if (mvLast != 0) {
+        mvResult = mvLast;
+      }
+      break;
+    }
+    mvLast = mvResult;
     // ɱ壬ֹ
     if (vl > WIN_VALUE || vl < -WIN_VALUE) {
       break;
     }
-    // һ룬ֹ
-    //if (clock() - t > CLOCKS_PER_SEC) {
-    float elapse = ((float) clock() - t) / CLOCKS_PER_SEC;
+    // Past the soft deadline, stop searching
+    elapse = std::chrono::duration<float>(std::chrono::steady_clock::now() - tpStart).count();
     printf("%s: Search depth DONE = [%d]. elapse=[%.02f]\n", __FUNCTION__, i, elapse);
-    if ( (int)elapse > s_search_time ) {
+    if (bTimed && std::chrono::steady_clock::now() >= lpEngine->tpSoft) {
       break;
     }
     printf("%s: Search depth START = [%d].\n", __FUNCTION__, i+1);
   }
   printf("%s: Search depth = *** [%d].\n", __FUNCTION__, i);
+
+  // Stop the helpers
+  lpEngine->bStop = true;
+  for (i = 0; i < (int) helpers.size(); i ++) {
+    helpers[i].join();
+  }
+  lpEngine->bStop = false;
 }
 
-// ʼ
-static void Startup(unsigned char board[10][9]) {
-  pos.Startup(board);
-  //Xqwl.sqSelected = Xqwl.mvLast = 0;
-  //Xqwl.bGameOver = FALSE;
+// What the previous search learned about move ordering is kept, but fades:
+// the history scores are halved, and the killers are shifted by the two plies
+// played since then (our move and the reply to it).
+void SearchStruct::AgeTables(void) {
+  int i;
+  for (i = 0; i < 65536; i ++) {
+    nHistoryTable[i] >>= 1;
+  }
+  memmove(mvKillers[0], mvKillers[2], (LIMIT_DEPTH - 2) * 2 * sizeof(int));
+  memset(mvKillers[LIMIT_DEPTH - 2], 0, 2 * 2 * sizeof(int));
+}
+
+// Start pondering, if enabled: make the reply we expect (the hash move of the
+// position after our move), then search on from there with no time limit.
+// The search runs on "Search" itself, so that on a ponder-hit it just goes on.
+void EngineStruct::StartPonder(void) {
+  HashItem hsh;
+  PositionStruct &pos = Search.pos;
+  if (!bPonder || lpHashTable == NULL) {
+    return;
+  }
+  lpHashTable[pos.zobr.dwKey & nHashMask].Load(hsh);
+  if (hsh.dwLock0 != pos.zobr.dwLock0 || hsh.dwLock1 != pos.zobr.dwLock1 ||
+      hsh.wmv == 0 || !pos.LegalMove(hsh.wmv) || !pos.MakeMove(hsh.wmv)) {
+    return;
+  }
+  mvPonder = hsh.wmv;
+  bPonderHit = FALSE;
+  Search.bTimed = false;
+  thPonder = std::thread(&SearchStruct::SearchMain, &Search, TRUE);
+}
+
+// Stop pondering: abort the search (what it found stays in the hash table),
+// and take back the expected reply unless the opponent did play it.
+void EngineStruct::StopPonder(void) {
+  if (!thPonder.joinable()) {
+    return;
+  }
+  bStop = true;
+  thPonder.join();
+  bStop = false;
+  if (!bPonderHit) {
+    Search.pos.UndoMakeMove();
+  }
+  mvPonder = 0;
+  bPonderHit = FALSE;
+}
+
+// On a ponder-hit, the running search is put on the clock (with the time
+// already spent pondering as a bonus), and its result is awaited.
+void EngineStruct::PonderHit(void) {
+  if (AllocateTime()) {
+    Search.bTimed = true;
+  }
+  thPonder.join();
+  mvPonder = 0;
+  bPonderHit = FALSE;
+}
+
+// Called every "TIME_POLL_NODES" nodes by the main search: past the hard
+// deadline, tell all the searches to stop (and unwind).
+void SearchStruct::PollTime(void) {
+  if (bTimed && std::chrono::steady_clock::now() >= lpEngine->tpHard) {
+    lpEngine->bStop = true;
+  }
+}
+
+// A lazy-SMP helper: the same iterative deepening as "SearchMain" (with every
+// other helper one ply ahead), until the main search tells it to stop.
+// Its results only reach the main search through the shared hash table.
+void SearchStruct::SearchHelper(int nHelper) {
+  int i;
+  AgeTables();
+  pos.nDistance = 0;
+  mvResult = 0;
+  for (i = 1 + (nHelper & 1); i < LIMIT_DEPTH && !Stopped(); i ++) {
+    SearchRoot(i);
+  }
+}
+
+// Count the legal move sequences of "nDepth" plies (the leaves of the move tree)
+static unsigned long long Perft(PositionStruct &pos, int nDepth) {
+  int i, nGenMoves;
+  int mvs[MAX_GEN_MOVES];
+  unsigned long long nLeaves;
+  if (nDepth <= 0) {
+    return 1;
+  }
+  nLeaves = 0;
+  nGenMoves = pos.GenerateMoves(mvs);
+  for (i = 0; i < nGenMoves; i ++) {
+    if (pos.MakeMove(mvs[i])) {
+      nLeaves += Perft(pos, nDepth - 1);
+      pos.UndoMakeMove();
+    }
+  }
+  return nLeaves;
 }
 
 /////////////////////////////////////////////////////////////
 ////////////////// HPHAN Code addition //////////////////////
 
+XQWLight::Engine::Engine()
+        : m_engine( new EngineStruct() )
+{
+    m_engine->nSearchDepth = 7;
+    m_engine->nMoveTime    = 1000;
+    m_engine->lpBook       = &SharedBook();  // Opened by the first Engine only
+    m_engine->nThreads     = 1;
+    m_engine->nHashSize    = HASH_MB_DEFAULT;
+    m_engine->Search.lpEngine = m_engine;
+    m_engine->Search.pos.Startup( NULL );
+}
+
+XQWLight::Engine::~Engine()
+{
+    delete m_engine;  // (which also stops pondering)
+}
+
 void
-XQWLight::init_engine( int searchDepth )
+XQWLight::Engine::init_engine( int searchDepth )
 {
+    m_engine->StopPonder();
+
     if ( searchDepth < LIMIT_DEPTH )
     {
-        s_search_depth = searchDepth;
+        m_engine->nSearchDepth = searchDepth;
+    }
+
+    if ( m_engine->lpHashTable == NULL )  // Keep the table across games.
+    {
+        m_engine->AllocHash();
     }
 }
 
 void
-XQWLight::init_game( unsigned char board[10][9] /* = NULL */,
-                     const char    side /* = 'w' */ )
+XQWLight::Engine::init_game( unsigned char board[10][9] /* = NULL */,
+                             const char    side /* = 'w' */ )
 {
+    m_engine->StopPonder();
+
     srand((DWORD) time(NULL));
-    InitZobrist();
     //Xqwl.hInst = hInstance;
-    LoadBook();
     //Xqwl.bFlipped = FALSE;
-    Startup(board);
+    m_engine->Search.pos.Startup(board);
 
     if ( side == 'b' )
     {
-        pos.ChangeSide();
+        m_engine->Search.pos.ChangeSide();
     }
 }
 
 std::string
-XQWLight::generate_move()
+XQWLight::Engine::generate_move()
 {
-    SearchMain();
+    SearchStruct& search = m_engine->Search;
+    if ( m_engine->bPonderHit )
+    {
+        m_engine->PonderHit();
+    }
+    else
+    {
+        m_engine->StopPonder();
+        if ( m_engine->lpHashTable == NULL )  // "init_engine" was not called?
+        {
+            m_engine->AllocHash();
+        }
+        search.SearchMain();
+    }
 
-    std::string stdMove = _xqwlight2hox( Search.mvResult ); 
-    pos.MakeMove( Search.mvResult );
+    std::string stdMove = _xqwlight2hox( search.mvResult );
+    search.pos.MakeMove( search.mvResult );
+    m_engine->StartPonder();
     return stdMove;
 }
 
 void
-XQWLight::on_human_move( const std::string& sMove )
+XQWLight::Engine::on_human_move( const std::string& sMove )
 {
+    SearchStruct& search = m_engine->Search;
     const std::string stdMove = sMove;
     unsigned int nMove = _hox2xqwlight( stdMove );
-    Search.mvResult = nMove;
-    pos.MakeMove( Search.mvResult );
+
+    if ( m_engine->thPonder.joinable() && ! m_engine->bPonderHit )
+    {
+        if ( (int) nMove == m_engine->mvPonder )  // Ponder-hit.
+        {
+            m_engine->bPonderHit = TRUE;
+            return;
+        }
+        m_engine->StopPonder();                   // Ponder-miss.
+    }
+    search.mvResult = nMove;
+    search.pos.MakeMove( search.mvResult );
+}
+
+void
+XQWLight::Engine::set_search_time( int nSeconds )
+{
+    m_engine->nMoveTime = nSeconds * 1000;
+}
+
+void
+XQWLight::Engine::set_move_time( int nMilliseconds )
+{
+    m_engine->nMoveTime = std::max( nMilliseconds, 0 );
+}
+
+void
+XQWLight::Engine::set_time_control( int nRemaining,
+                                    int nIncrement /* = 0 */,
+                                    int nMovesToGo /* = 0 */ )
+{
+    m_engine->nGameTime  = std::max( nRemaining, 0 );
+    m_engine->nIncrement = std::max( nIncrement, 0 );
+    m_engine->nMovesToGo = std::max( nMovesToGo, 0 );
+}
+
+void
+XQWLight::Engine::set_ponder( bool bPonder )
+{
+    if ( ! bPonder )
+    {
+        m_engine->StopPonder();
+    }
+    m_engine->bPonder = bPonder;
+}
+
+void
+XQWLight::Engine::set_threads( int nThreads )
+{
+    if      ( nThreads < 1 )           nThreads = 1;
+    else if ( nThreads > MAX_THREADS ) nThreads = MAX_THREADS;
+
+    if ( nThreads != m_engine->nThreads )
+    {
+        m_engine->StopPonder();
+        m_engine->SetThreads( nThreads );
+    }
+}
+
+void
+XQWLight::Engine::set_hash_size( int nMB )
+{
+    if      ( nMB < 1 )           nMB = 1;
+    else if ( nMB > HASH_MB_MAX ) nMB = HASH_MB_MAX;
+
+    if ( nMB != m_engine->nHashSize )
+    {
+        m_engine->nHashSize = nMB;
+        if ( m_engine->lpHashTable != NULL )  // Already allocated?
+        {
+            m_engine->StopPonder();
+            m_engine->AllocHash();
+        }
+    }
+}
+
+unsigned long long
+XQWLight::Engine::perft( int depth )
+{
+    m_engine->StopPonder();
+    return Perft( m_engine->Search.pos, depth );
+}
+
+unsigned long long
+XQWLight::Engine::get_node_count() const
+{
+    return m_engine->Search.nNodes;
+}
+
+/**
+ * The default Engine behind the (old) process-wide API below.
+ */
+static XQWLight::Engine&
+_DefaultEngine()
+{
+    static XQWLight::Engine s_engine;
+    return s_engine;
+}
+
+void
+XQWLight::init_engine( int searchDepth )
+{
+    _DefaultEngine().init_engine( searchDepth );
+}
+
+void
+XQWLight::init_game( unsigned char board[10][9] /* = NULL */,
+                     const char    side /* = 'w' */ )
+{
+    _DefaultEngine().init_game( board, side );
+}
+
+std::string
+XQWLight::generate_move()
+{
+    return _DefaultEngine().generate_move();
+}
+
+void
+XQWLight::on_human_move( const std::string& sMove )
+{
+    _DefaultEngine().on_human_move( sMove );
 }
 
 void
 XQWLight::set_search_time( int nSeconds )
 {
-    s_search_time = nSeconds;
+    _DefaultEngine().set_search_time( nSeconds );
+}
+
+void
+XQWLight::set_move_time( int nMilliseconds )
+{
+    _DefaultEngine().set_move_time( nMilliseconds );
+}
+
+void
+XQWLight::set_time_control( int nRemaining,
+                            int nIncrement /* = 0 */,
+                            int nMovesToGo /* = 0 */ )
+{
+    _DefaultEngine().set_time_control( nRemaining, nIncrement, nMovesToGo );
+}
+
+void
+XQWLight::set_ponder( bool bPonder )
+{
+    _DefaultEngine().set_ponder( bPonder );
+}
+
+void
+XQWLight::set_threads( int nThreads )
+{
+    _DefaultEngine().set_threads( nThreads );
+}
+
+void
+XQWLight::set_hash_size( int nMB )
+{
+    _DefaultEngine().set_hash_size( nMB );
+}
+
+unsigned long long
+XQWLight::perft( int depth )
+{
+    return _DefaultEngine().perft( depth );
+}
+
+unsigned long long
+XQWLight::get_node_count()
+{
+    return _DefaultEngine().get_node_count();
 }
 
 unsigned int
@@ -42,7 +42,61 @@
 
 namespace XQWLight
 {
-	/* PUBLIC API */
+    struct EngineStruct;  // The engine's state (defined in XQWLight.cpp).
+
+    /**
+     * An independent XQWLight engine.
+     *
+     * Each Engine owns its own position, search tables, hash table and book,
+     * so that several Engines can run at the same time on separate threads.
+     */
+    class Engine
+    {
+    public:
+        Engine();
+        ~Engine();
+
+        void init_engine( int searchDepth );
+
+        void init_game( unsigned char board[10][9] = NULL,
+                        const char    side = 'w' );
+
+        std::string generate_move();
+        void        on_human_move( const std::string& sMove );
+
+        void set_search_time( int nSeconds );
+        void set_move_time( int nMilliseconds );
+        void set_time_control( int nRemaining,
+                               int nIncrement = 0,
+                               int nMovesToGo = 0 );
+            /* The game clock (in ms): the time left, the increment per move,
+             * and the number of moves to the next control (0 = the rest of
+             * the game). It must be updated before each generate_move().
+             * Each move gets a share of it (and of the increment), but never
+             * more than the time per move, if that is set too.
+             */
+        void set_ponder( bool bPonder );
+            /* Search the expected reply while the opponent thinks. */
+        void set_threads( int nThreads );
+            /* Lazy SMP: the number of threads searching each move. */
+        void set_hash_size( int nMB );
+            /* The hash table size (in MB). It is allocated by init_engine(). */
+
+        unsigned long long perft( int depth );
+            /* The number of legal move sequences of 'depth' plies from the
+             * current position (to check and time the move generator).
+             */
+        unsigned long long get_node_count() const;
+            /* The nodes searched (by the main thread) in the last search. */
+
+    private:
+        Engine( const Engine& );             // Not copyable.
+        Engine& operator=( const Engine& );  // Not assignable.
+
+        EngineStruct*  m_engine;
+    };
+
+	/* PUBLIC API (operating on a default, process-wide Engine) */
 
     void init_engine( int searchDepth );
 
@@ -54,6 +108,17 @@ namespace XQWLight
 
     void set_search_time( int nSeconds );
 	    /* Only approximately... */
+    void set_move_time( int nMilliseconds );
+    void set_time_control( int nRemaining,
+                           int nIncrement = 0,
+                           int nMovesToGo = 0 );
+
+    void set_ponder( bool bPonder );
+    void set_threads( int nThreads );
+    void set_hash_size( int nMB );
+
+    unsigned long long perft( int depth );
+    unsigned long long get_node_count();
 
 
     /* PRIVATE API (declared here for documentation purpose) */
@@ -0,0 +1,674 @@
+/***************************************************************************
+ *  Copyright 2007-2009 Huy Phan  <huyphan@playxiangqi.com>                *
+ *                      Bharatendra Boddu (bharathendra at yahoo dot com)  *
+ *                                                                         *
+ *  This file is part of HOXChess.                                         *
+ *                                                                         *
+ *  HOXChess is free software: you can redistribute it and/or modify       *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  HOXChess is distributed in the hope that it will be useful,            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with HOXChess.  If not, see <http://www.gnu.org/licenses/>.      *
+ ***************************************************************************/
+
+/////////////////////////////////////////////////////////////////////////////
+// Name:            bench.cpp
+// Created:         10/16/2026
+//
+// Description:     A headless benchmark of the AI Engine Plugins.
+//
+//   For each plugin and each position of a fixed suite, it runs:
+//     - perft (the move generator: make/unmake speed), with the counts
+//       checked against the known ones up to depth 4,
+//     - a fixed-depth search at each difficulty level (nodes, time, NPS),
+//     - a search on a short clock (1 ms), which must still return a move.
+//   Then, for each plugin, perft(3) at every position of the game that
+//   the suite is taken from, checked against the known counts.
+//   All count the heap allocations (by operator new) they make.
+//   The results go to the standard output as CSV or JSON, so that runs
+//   can be compared (and regressions caught) from one build to the next.
+//
+//   With "-t N", it runs a stress test instead: N threads search the
+//   suite at the same time, each with its own engine, and the results must
+//   be the same as those of one thread alone.
+//
+//   Usage: bench [-d plugins-dir] [-p perft-depth] [-s max-level]
+//                [-t threads] [-f csv|json] [engine ...]
+//
+//   Run it from "plugins/bench" (the XQWLight book is looked up there).
+/////////////////////////////////////////////////////////////////////////////
+
+#include <AIEngineLib.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __APPLE__
+  #define PLUGIN_EXT  ".dylib"
+#else
+  #define PLUGIN_EXT  ".so"
+#endif
+
+/**
+ * The engines bundled with HOXChess.
+ */
+struct BenchEngine
+{
+    const char* name;
+    bool        stress;  // Can several instances search at the same time,
+                         // with the same results each time?
+};
+
+static const BenchEngine s_engines[] =
+    {
+        { "XQWLight", false },  // It adds some randomness to its moves.
+        { "Folium",   true  },
+        { "TSITO",    false },  // The options are global.
+        { "HaQiKiD",  false },  // The whole engine is global.
+        { "MaxQi",    false },  // The whole engine is global.
+        { NULL,       false }
+    };
+
+/**
+ * The heap allocations made so far, by any code: the plugins' calls to
+ * operator new are bound to this one when they are loaded.
+ */
+static std::atomic<unsigned long long> s_allocations( 0 );
+
+void* operator new( std::size_t size )
+{
+    s_allocations.fetch_add( 1, std::memory_order_relaxed );
+    void* p = malloc( size ? size : 1 );
+    if ( p == NULL )
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete( void* p ) noexcept
+{
+    free( p );
+}
+
+void operator delete( void* p, std::size_t ) noexcept
+{
+    free( p );
+}
+
+/**
+ * The position suite.
+ *
+ * Every position is given as the moves played from the initial position,
+ * rather than as a FEN, because not all engines accept a FEN.
+ * They are taken from one game, at various stages.
+ */
+static const char* s_gameMoves =
+    "7747 1022 7967 8081 8979 8131 2625 3134 1927 7082 7975 0001 1713 0151 "
+    "7535 3414 1343 2243 4743 7277 3532 1213 2735 1343 3543 5153 2524 1417 "
+    "4331 5041 3262 1767 6260 5350 6050 4050 2947 2324 0929 7771 3112 7179 "
+    "2927 6766 4645 6646 1220 4645 2737 4546 2012 2425 3948 2526 1233 2636 "
+    "3717 4643 3321 4323 2142 2324 1715 2422 4234 2252 3455 3626 1525 6364 "
+    "5567 7972 2526 7262 6775 6261 2656 5256 7556 6465 5635 0304 3554 6555 "
+    "5475 6166 7554 8263 5433 6344 3321 4436 4939 8384 2113 6606 6987 0686 "
+    "1301 0405 4769 8485 6947 8676 8769 7679 0113 0506 3938 5556 1325 0616 "
+    "2533 8586 3354 1626 5475 5666 7554 6667 3839 6768 5466 3648 3949 4867 "
+    "6645 2627 4939 6858 3938 2728 3837 7976 4524 6759 4729 7679 2405 2838 "
+    "0526 5848 2645 5967 2907 7977 6947 6755 4769 7707 4526 0709 2638 0901 "
+    "3817 4132 1736 5536 3747 3628 4748 0108";
+
+/**
+ * The perft depths that have known counts.
+ */
+static const int s_numKnownPerfts = 4;
+
+struct BenchPosition
+{
+    const char*         name;
+    int                 nPlies;  // The number of moves (of the game) to play first.
+    unsigned long long  perft[s_numKnownPerfts];  // At depths 1, 2, ...
+};
+
+static const BenchPosition s_positions[] =
+    {
+        { "start",      0,   { 44, 1920, 79666, 3290240 } },
+        { "opening",    10,  { 38, 1926, 73557, 3524384 } },
+        { "middlegame", 30,  { 35, 1667, 55355, 2567223 } },
+        { "late",       80,  { 16, 301,  4569,  93928   } },
+        { "endgame",    130, { 13, 373,  4335,  122005  } },
+    };
+
+static const int s_numPositions = sizeof(s_positions) / sizeof(s_positions[0]);
+
+/**
+ * The perft counts at every position of the game: before the first move,
+ * then after each one. Like those of the suite, they come from XQWLight's
+ * original (mailbox) move generator, which later generators must match.
+ */
+static const int s_gamePerftDepth = 3;
+
+static const unsigned long long s_gamePerft[] =
+    {
+         79666,  66333,  48820,  56749,  55769,  83003,  73455,  97363,
+         73863, 100721,  73557,  93736,  98935, 107025, 104455, 121254,
+         81643, 107123,  80712, 126350,  92187, 114762,  93647,  93170,
+         13635, 102007,  64327,  67750,  64123,  69922,  55355,  70839,
+         39440,   1822,  21114,   1231,  12379,  14588,   9421,  13942,
+         13488,  21344,  13644,  20848,  16113,  28121,  12347,  16525,
+          9001,  20229,  11332,  23664,  15055,  31902,  20855,  26196,
+         13686,  27963,  20266,  26289,  21884,  29324,  25186,  39680,
+         28653,  43186,  32882,  30821,  27620,  27661,  22540,  35824,
+         24173,  29330,  21513,  22180,  24590,  10840,   6341,   4292,
+          4569,   6374,   5141,   6320,   5456,   7676,   5897,   9457,
+          6128,  11857,   8980,  12865,   5334,  10745,   5754,  11312,
+          4401,   8795,   4384,   5837,   3067,   4529,   1926,   6025,
+          3722,   9456,   2613,  10106,   4159,  10190,   4017,  11459,
+          4722,  12329,   5431,  11137,   4281,   6201,   3697,  10203,
+          5059,  10071,   4628,  10264,   3390,   8515,   2398,   9675,
+          3788,  10366,   4335,   8965,    682,   9625,   4600,  13535,
+          3167,   8150,   2704,   4020,   1316,   5207,   2096,   5306,
+          3090,   7643,    419,   6471,    784,   6736,   1887,   8292,
+          2231,   3916,    658,   6799,   1798,   8273,    267,   2097,
+           159,   2315,      0
+    };
+
+static const int s_numGamePerfts = sizeof(s_gamePerft) / sizeof(s_gamePerft[0]);
+
+/**
+ * The short clocks: the option that sets each one, to 1 ms.
+ */
+static const char* s_shortClocks[] = { "MoveTime", "GameTime" };
+
+static const int s_numShortClocks = sizeof(s_shortClocks) / sizeof(s_shortClocks[0]);
+
+/**
+ * The benchmark settings (from the command line).
+ */
+struct BenchOptions
+{
+    std::string               dir;          // Where the plugins are.
+    int                       perftDepth;
+    int                       maxLevel;     // Search at levels 1..maxLevel.
+    int                       threads;      // > 0 for the stress test.
+    bool                      json;
+    std::vector<std::string>  engines;
+
+    BenchOptions() : dir( ".." ), perftDepth( 3 ), maxLevel( 3 )
+                   , threads( 0 ), json( false ) {}
+};
+
+/**
+ * The results writer, in CSV or JSON.
+ */
+class BenchReport
+{
+public:
+    BenchReport( FILE* out, bool json )
+        : m_out( out ), m_json( json ), m_count( 0 )
+    {
+        if ( m_json ) fprintf( m_out, "[\n" );
+        else          fprintf( m_out, "engine,position,test,depth,nodes,time_ms,nps,allocs,move,status\n" );
+    }
+
+    ~BenchReport()
+    {
+        if ( m_json ) fprintf( m_out, "\n]\n" );
+    }
+
+    void add( const std::string& engine,
+              const std::string& position,
+              const std::string& test,
+              int                depth,
+              unsigned long long nodes,
+              double             ms,
+              unsigned long long allocs,
+              const std::string& move,
+              const std::string& status )
+    {
+        const unsigned long long nps =
+            ( ms > 0 ? (unsigned long long) ( nodes * 1000.0 / ms ) : 0 );
+
+        if ( m_json )
+        {
+            fprintf( m_out, "%s  {\"engine\": \"%s\", \"position\": \"%s\", \"test\": \"%s\", "
+                            "\"depth\": %d, \"nodes\": %llu, \"time_ms\": %.1f, \"nps\": %llu, "
+                            "\"allocs\": %llu, \"move\": \"%s\", \"status\": \"%s\"}",
+                     ( m_count ? ",\n" : "" ), engine.c_str(), position.c_str(), test.c_str(),
+                     depth, nodes, ms, nps, allocs, move.c_str(), status.c_str() );
+        }
+        else
+        {
+            fprintf( m_out, "%s,%s,%s,%d,%llu,%.1f,%llu,%llu,%s,%s\n",
+                     engine.c_str(), position.c_str(), test.c_str(),
+                     depth, nodes, ms, nps, allocs, move.c_str(), status.c_str() );
+        }
+        fflush( m_out );
+        ++m_count;
+    }
+
+private:
+    FILE*  m_out;
+    bool   m_json;
+    int    m_count;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double
+_elapsedMs( const std::chrono::steady_clock::time_point& start )
+{
+    return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start ).count();
+}
+
+static const char*
+_statusString( int rc )
+{
+    switch ( rc )
+    {
+        case hoxAI_RC_OK:            return "ok";
+        case hoxAI_RC_NOT_SUPPORTED: return "not-supported";
+        default:                     return "error";
+    }
+}
+
+/**
+ * Create an engine at a position of the suite.
+ */
+static AIEngineLib*
+_createEngine( PICreateAIEngineLibFunc   pfnCreate,
+               int                       nAILevel,
+               const BenchPosition&      position )
+{
+    AIEngineLib* engine = pfnCreate();
+    if ( engine == NULL )
+    {
+        return NULL;
+    }
+
+    engine->initEngine( nAILevel );
+    if ( engine->initGame( "", MoveList() ) != hoxAI_RC_OK )
+    {
+        delete engine;
+        return NULL;
+    }
+    engine->setDifficultyLevel( nAILevel );
+    engine->setOption( "MoveTime", "0" );  // Search to the full depth.
+
+    std::istringstream moves( s_gameMoves );
+    std::string        sMove;
+    for ( int i = 0; i < position.nPlies && (moves >> sMove); ++i )
+    {
+        engine->onHumanMove( sMove );
+    }
+    return engine;
+}
+
+/**
+ * Load a plugin.
+ *
+ * @return The plugin's handle, or NULL if it could not be loaded.
+ */
+static void*
+_loadEngineLib( const std::string&        engineName,
+                const BenchOptions&       options,
+                PICreateAIEngineLibFunc&  pfnCreate )
+{
+    const std::string sPath = options.dir + "/AI_" + engineName + PLUGIN_EXT;
+
+    void* handle = dlopen( sPath.c_str(), RTLD_NOW | RTLD_LOCAL );
+    if ( handle == NULL )
+    {
+        fprintf( stderr, "bench: Failed to load [%s]: %s\n", sPath.c_str(), dlerror() );
+        return NULL;
+    }
+
+    pfnCreate = (PICreateAIEngineLibFunc) dlsym( handle, "CreateAIEngineLib" );
+    if ( pfnCreate == NULL )
+    {
+        fprintf( stderr, "bench: No 'CreateAIEngineLib' in [%s].\n", sPath.c_str() );
+        dlclose( handle );
+        return NULL;
+    }
+    return handle;
+}
+
+/**
+ * Perft at every position of the game, in one engine that plays the
+ * moves one by one.
+ */
+static void
+_perftGame( const std::string&        engineName,
+            PICreateAIEngineLibFunc   pfnCreate,
+            BenchReport&              report )
+{
+    AIEngineLib* engine = _createEngine( pfnCreate, 1, s_positions[0] );
+    if ( engine == NULL )
+    {
+        report.add( engineName, "game", "perft", s_gamePerftDepth,
+                    0, 0, 0, "", "error" );
+        return;
+    }
+
+    std::istringstream moves( s_gameMoves );
+    std::string        sMove;
+    unsigned long long total = 0;
+    int                nMismatches = 0;
+    int                rc = hoxAI_RC_OK;
+    unsigned long long allocs = s_allocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for ( int ply = 0; ply < s_numGamePerfts && rc == hoxAI_RC_OK; ++ply )
+    {
+        if ( ply > 0 && (moves >> sMove) )
+        {
+            engine->onHumanMove( sMove );
+        }
+        unsigned long long nodes = 0;
+        rc = engine->perft( s_gamePerftDepth, nodes );
+        if ( rc == hoxAI_RC_OK && nodes != s_gamePerft[ply] )
+        {
+            fprintf( stderr, "bench: %s game ply %d perft %d: %llu instead of %llu.\n",
+                     engineName.c_str(), ply, s_gamePerftDepth, nodes, s_gamePerft[ply] );
+            ++nMismatches;
+        }
+        total += nodes;
+    }
+    const double ms = _elapsedMs( start );
+    allocs = s_allocations - allocs;
+    report.add( engineName, "game", "perft", s_gamePerftDepth, total, ms, allocs, "",
+                ( rc != hoxAI_RC_OK ? _statusString( rc )
+                                    : ( nMismatches ? "mismatch" : "ok" ) ) );
+    delete engine;
+}
+
+static void
+_benchEngine( const std::string&    engineName,
+              const BenchOptions&   options,
+              BenchReport&          report )
+{
+    PICreateAIEngineLibFunc pfnCreate = NULL;
+    void* handle = _loadEngineLib( engineName, options, pfnCreate );
+    if ( handle == NULL )
+    {
+        report.add( engineName, "", "load", 0, 0, 0, 0, "", "error" );
+        return;
+    }
+
+    for ( int p = 0; p < s_numPositions; ++p )
+    {
+        const BenchPosition& position = s_positions[p];
+
+        /* Perft. */
+        AIEngineLib* engine = _createEngine( pfnCreate, 1, position );
+        if ( engine == NULL )
+        {
+            report.add( engineName, position.name, "perft", options.perftDepth,
+                        0, 0, 0, "", "error" );
+            continue;
+        }
+        unsigned long long nodes = 0;
+        unsigned long long allocs = s_allocations;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int rc = engine->perft( options.perftDepth, nodes );
+        double ms = _elapsedMs( start );
+        allocs = s_allocations - allocs;
+        const char* status = _statusString( rc );
+        if (    rc == hoxAI_RC_OK
+             && options.perftDepth >= 1 && options.perftDepth <= s_numKnownPerfts
+             && nodes != position.perft[options.perftDepth - 1] )
+        {
+            fprintf( stderr, "bench: %s %s perft %d: %llu instead of %llu.\n",
+                     engineName.c_str(), position.name, options.perftDepth,
+                     nodes, position.perft[options.perftDepth - 1] );
+            status = "mismatch";
+        }
+        report.add( engineName, position.name, "perft", options.perftDepth,
+                    nodes, ms, allocs, "", status );
+        delete engine;
+
+        /* Search, one fresh engine per level (so that no hash entries
+         * are carried over from the previous level).
+         */
+        for ( int level = 1; level <= options.maxLevel; ++level )
+        {
+            engine = _createEngine( pfnCreate, level, position );
+            if ( engine == NULL )
+            {
+                report.add( engineName, position.name, "search", level,
+                            0, 0, 0, "", "error" );
+                continue;
+            }
+            allocs = s_allocations;
+            start = std::chrono::steady_clock::now();
+            const std::string sMove = engine->generateMove();
+            ms = _elapsedMs( start );
+            allocs = s_allocations - allocs;
+            nodes = 0;
+            rc = engine->getNodeCount( nodes );
+            report.add( engineName, position.name, "search", level,
+                        nodes, ms, allocs, sMove, _statusString( rc ) );
+            delete engine;
+        }
+
+        /* Search on a short clock: no move at all would lose the game. */
+        for ( int c = 0; c < s_numShortClocks; ++c )
+        {
+            const std::string test = std::string( "clock-" ) + s_shortClocks[c];
+            engine = _createEngine( pfnCreate, options.maxLevel, position );
+            if ( engine == NULL )
+            {
+                report.add( engineName, position.name, test, options.maxLevel,
+                            0, 0, 0, "", "error" );
+                continue;
+            }
+            rc = engine->setOption( s_shortClocks[c], "1" );
+            if ( rc != hoxAI_RC_OK )
+            {
+                report.add( engineName, position.name, test, options.maxLevel,
+                            0, 0, 0, "", _statusString( rc ) );
+                delete engine;
+                continue;
+            }
+            allocs = s_allocations;
+            start = std::chrono::steady_clock::now();
+            const std::string sMove = engine->generateMove();
+            ms = _elapsedMs( start );
+            allocs = s_allocations - allocs;
+            nodes = 0;
+            engine->getNodeCount( nodes );
+            report.add( engineName, position.name, test, options.maxLevel,
+                        nodes, ms, allocs, sMove, ( sMove.empty() ? "no-move" : "ok" ) );
+            delete engine;
+        }
+    }
+
+    _perftGame( engineName, pfnCreate, report );
+
+    dlclose( handle );
+}
+
+/**
+ * The result of one search of the stress test.
+ */
+struct StressResult
+{
+    std::string         move;
+    unsigned long long  nodes;
+
+    bool operator==( const StressResult& other ) const
+        { return move == other.move && nodes == other.nodes; }
+};
+
+typedef std::vector<StressResult> StressResults;
+
+/**
+ * Search every position of the suite at every level, with a new engine
+ * each time (as the search test does).
+ */
+static void
+_stressRun( PICreateAIEngineLibFunc  pfnCreate,
+            const BenchOptions&      options,
+            StressResults&           results )
+{
+    for ( int p = 0; p < s_numPositions; ++p )
+    {
+        for ( int level = 1; level <= options.maxLevel; ++level )
+        {
+            StressResult result;
+            result.nodes = 0;
+            AIEngineLib* engine = _createEngine( pfnCreate, level, s_positions[p] );
+            if ( engine != NULL )
+            {
+                result.move = engine->generateMove();
+                engine->getNodeCount( result.nodes );
+                delete engine;
+            }
+            results.push_back( result );
+        }
+    }
+}
+
+static void
+_stressEngine( const std::string&    engineName,
+               const BenchOptions&   options,
+               BenchReport&          report )
+{
+    PICreateAIEngineLibFunc pfnCreate = NULL;
+    void* handle = _loadEngineLib( engineName, options, pfnCreate );
+    if ( handle == NULL )
+    {
+        report.add( engineName, "", "load", 0, 0, 0, 0, "", "error" );
+        return;
+    }
+
+    /* The reference: one thread alone. */
+    StressResults expected;
+    _stressRun( pfnCreate, options, expected );
+
+    /* All threads at the same time. */
+    std::vector<StressResults>  results( options.threads );
+    std::vector<std::thread>    threads;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < options.threads; ++i )
+    {
+        threads.push_back( std::thread( _stressRun, pfnCreate,
+                                        std::cref( options ), std::ref( results[i] ) ) );
+    }
+    for ( int i = 0; i < options.threads; ++i )
+    {
+        threads[i].join();
+    }
+    const double ms = _elapsedMs( start );
+
+    size_t index = 0;
+    for ( int p = 0; p < s_numPositions; ++p )
+    {
+        for ( int level = 1; level <= options.maxLevel; ++level, ++index )
+        {
+            int nMismatches = 0;
+            for ( int i = 0; i < options.threads; ++i )
+            {
+                if ( ! ( results[i][index] == expected[index] ) )
+                {
+                    fprintf( stderr, "bench: %s %s level %d, thread %d: %s (%llu nodes)"
+                                     " instead of %s (%llu nodes).\n",
+                             engineName.c_str(), s_positions[p].name, level, i,
+                             results[i][index].move.c_str(), results[i][index].nodes,
+                             expected[index].move.c_str(), expected[index].nodes );
+                    ++nMismatches;
+                }
+            }
+            report.add( engineName, s_positions[p].name, "stress", level,
+                        expected[index].nodes * options.threads, ms, 0,
+                        expected[index].move, ( nMismatches ? "mismatch" : "ok" ) );
+        }
+    }
+
+    dlclose( handle );
+}
+
+static void
+_usage()
+{
+    fprintf( stderr,
+        "Usage: bench [-d plugins-dir] [-p perft-depth] [-s max-level]\n"
+        "             [-t threads] [-f csv|json] [engine ...]\n"
+        "  The engines are: XQWLight Folium TSITO HaQiKiD MaxQi (default: all,\n"
+        "  or with -t, those that can be stress-tested).\n" );
+}
+
+int
+main( int argc, char** argv )
+{
+    BenchOptions options;
+
+    int opt;
+    while ( (opt = getopt( argc, argv, "d:p:s:t:f:h" )) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'd': options.dir        = optarg;                 break;
+            case 'p': options.perftDepth = ::atoi( optarg );       break;
+            case 's': options.maxLevel   = ::atoi( optarg );       break;
+            case 't': options.threads    = ::atoi( optarg );       break;
+            case 'f': options.json       = ( strcmp( optarg, "json" ) == 0 ); break;
+            default:  _usage(); return 1;
+        }
+    }
+    for ( int i = optind; i < argc; ++i )
+    {
+        options.engines.push_back( argv[i] );
+    }
+    if ( options.engines.empty() )
+    {
+        for ( int i = 0; s_engines[i].name != NULL; ++i )
+        {
+            if ( options.threads == 0 || s_engines[i].stress )
+            {
+                options.engines.push_back( s_engines[i].name );
+            }
+        }
+    }
+
+    /* The engines print their own traces to the standard output.
+     * Keep it for the results, and send the rest to the standard error.
+     */
+    FILE* out = fdopen( dup( STDOUT_FILENO ), "w" );
+    if ( out == NULL )
+    {
+        perror( "bench" );
+        return 1;
+    }
+    fflush( stdout );
+    dup2( STDERR_FILENO, STDOUT_FILENO );
+
+    {
+        BenchReport report( out, options.json );
+        for ( size_t i = 0; i < options.engines.size(); ++i )
+        {
+            if ( options.threads > 0 ) _stressEngine( options.engines[i], options, report );
+            else                       _benchEngine( options.engines[i], options, report );
+        }
+    }
+
+    fclose( out );
+    return 0;
+}
+
+/************************* END OF FILE ***************************************/
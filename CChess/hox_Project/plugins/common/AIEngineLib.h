@@ -87,6 +87,34 @@ public:
 
     virtual std::string getInfo() { return ""; }
 
+    /**
+     * Set an engine-specific option, such as "Threads".
+     *
+     * @return hoxAI_RC_NOT_SUPPORTED if the engine does not know the option.
+     */
+    virtual int         setOption( const std::string& name,
+                                   const std::string& value )
+        { return hoxAI_RC_NOT_SUPPORTED; }
+
+    /**
+     * Count the positions reached by all the legal move sequences of
+     * 'depth' plies from the current position (perft). Used to check
+     * and time the move generator.
+     *
+     * @return hoxAI_RC_NOT_SUPPORTED if the engine cannot do it.
+     */
+    virtual int         perft( int                 depth,
+                               unsigned long long& nodes )
+        { return hoxAI_RC_NOT_SUPPORTED; }
+
+    /**
+     * Get the number of nodes searched by the last generateMove().
+     *
+     * @return hoxAI_RC_NOT_SUPPORTED if the engine does not count them.
+     */
+    virtual int         getNodeCount( unsigned long long& nodes )
+        { return hoxAI_RC_NOT_SUPPORTED; }
+
     void operator delete(void* p)
         {
             if (p)
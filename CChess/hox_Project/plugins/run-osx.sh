@@ -7,6 +7,7 @@ if [ "$1" == "clean" ]; then
     cd ../AI_MaxQi && make -f Makefile.osx clean
     cd ../AI_Folium && make -f Makefile.osx clean
     cd ../AI_TSITO && make -f Makefile.osx clean
+    cd ../bench && make -f Makefile.osx clean
     exit 0
 fi
 
@@ -15,3 +16,4 @@ cd ../AI_HaQiKiD && make -f Makefile.osx
 cd ../AI_MaxQi && make -f Makefile.osx
 cd ../AI_Folium && make -f Makefile.osx
 cd ../AI_TSITO && make -f Makefile.osx
+cd ../bench && make -f Makefile.osx
@@ -7,6 +7,7 @@ if [ "$1" == "clean" ]; then
     cd ../AI_MaxQi && make clean
     cd ../AI_Folium && make clean
     cd ../AI_TSITO && make clean
+    cd ../bench && make clean
     exit 0
 fi
 
@@ -15,3 +16,4 @@ cd ../AI_HaQiKiD && make
 cd ../AI_MaxQi && make
 cd ../AI_Folium && make
 cd ../AI_TSITO && make
+cd ../bench && make